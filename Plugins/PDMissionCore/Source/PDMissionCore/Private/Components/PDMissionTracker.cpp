@@ -2,9 +2,14 @@
 #include "Components/PDMissionTracker.h"
 #include "Subsystems/PDMissionSubsystem.h"
 #include "Net/MissionDatum.h"
+#include "Interfaces/PDMissionInterface.h"
+#include "Data/PDMissionStateMachine.h"
 
 #include <Engine/NetDriver.h>
+#include <Engine/World.h>
+#include <TimerManager.h>
 #include <Net/UnrealNetwork.h>
+#include <Net/Core/PushModel/PushModel.h>
 
 
 void UPDMissionTracker::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
@@ -17,6 +22,131 @@ void UPDMissionTracker::GetLifetimeReplicatedProps(TArray<class FLifetimePropert
 	SharedParams.Condition    = COND_None;
 	
 	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTracker, State, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTracker, Pages, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTracker, GroupTracker, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTracker, SharedMissionTags, SharedParams);
+}
+
+//
+// Tracker page
+
+void UPDMissionTrackerPage::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	FDoRepLifetimeParams SharedParams;
+	SharedParams.bIsPushBased = true;
+	SharedParams.Condition    = COND_None;
+
+	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTrackerPage, PageTag, SharedParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UPDMissionTrackerPage, State, SharedParams);
+}
+
+void UPDMissionTrackerPage::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Pages created by the net driver on clients need their owner for the item callbacks as-well
+	State.OwnerTracker = GetTypedOuter<UPDMissionTracker>();
+}
+
+//
+// Tracker
+
+UPDMissionTracker::UPDMissionTracker(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	// Only ticks while there are staged or throttled changes to flush, after everything else has had a chance to change missions this frame
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_LastDemotable;
+
+	// Pages are registered as replicated subobjects when they are created
+	bReplicateUsingRegisteredSubObjectList = true;
+}
+
+void UPDMissionTracker::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	FlushPendingChanges();
+	DrainThrottledChanges();
+	SetComponentTickEnabled(HasThrottledChanges());
+}
+
+void UPDMissionTracker::OnRegister()
+{
+	Super::OnRegister();
+
+	// Replicated item callbacks on clients go through the owner, needs to be set before the first snapshot or delta arrives
+	State.OwnerTracker = this;
+
+	const UWorld* World = GetWorld();
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (World == nullptr || World->IsGameWorld() == false || MissionSubsystem == nullptr) { return; }
+
+	MissionSubsystem->Utility.RegisterUser(this);
+	ArmDeadlineTimer();
+}
+
+void UPDMissionTracker::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Once per owning client is enough, the checksum is kept per connection
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem != nullptr && MissionSubsystem->Utility.GetLocallyOwnedTracker() == this)
+	{
+		ServerReportDatabaseChecksum(MissionSubsystem->Utility.GetDatabaseChecksum());
+	}
+}
+
+void UPDMissionTracker::OnUnregister()
+{
+	FlushPendingChanges();
+	
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem != nullptr && ActorID != INDEX_NONE)
+	{
+		MissionSubsystem->Utility.DeRegisterUser(this);
+	}
+	ActorID = INDEX_NONE;
+
+	if (const UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(DeadlineTimerHandle);
+	}
+
+	Super::OnUnregister();
+}
+
+bool UPDMissionTracker::TransitionMission(const FGameplayTag& BaseTag, const EPDMissionEvent Event, const double DeadlineSeconds)
+{
+	if (GetOwnerRole() != ROLE_Authority) { return false; }
+
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return false; }
+
+	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
+	if (MissionSubsystem->Utility.IsValidMission(mID) == false) { return false; }
+
+	// Shared missions are only ever written to the group copy
+	UPDMissionTracker* OwningTracker = ResolveOwningTracker(mID);
+	if (OwningTracker != this)
+	{
+		return OwningTracker->TransitionMission(BaseTag, Event, DeadlineSeconds);
+	}
+
+	// Changes made while a transaction is open are applied with the rest of the transaction, and validated when it commits
+	if (Transaction.bIsOpen)
+	{
+		Transaction.StagedEvents.Add(FPDMissionStagedEvent{mID, Event, EPDMissionState::EINVALID_STATE, DeadlineSeconds});
+		return true;
+	}
+
+	// Deadline effects are applied together with the state change, a pending state can not be entered without one
+	FPDMissionNetDatum OverrideDatum = CopyCurrentDatum(mID);
+	if (FPDMissionStateMachine::Apply(OverrideDatum, Event, DeadlineSeconds) == false) { return false; }
+
+	ApplyMissionDatum(mID, OverrideDatum);
+	return true;
 }
 
 bool UPDMissionTracker::SetMissionDatum(const FGameplayTag& BaseTag, const FPDMissionNetDatum& OverrideDatum)
@@ -27,51 +157,182 @@ bool UPDMissionTracker::SetMissionDatum(const FGameplayTag& BaseTag, const FPDMi
 	if (MissionSubsystem == nullptr) { return false; }
 
 	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
-	const FPDMissionRow* DefaultData = MissionSubsystem->Utility.GetDefaultBase(mID);
-	if (DefaultData == nullptr) { return false; }
-	
-	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, State, this);
-	int32 ArrayIndex = mIDToReplIdMap.Contains(mID) ? *mIDToReplIdMap.Find(mID) -1 : INDEX_NONE;
-	if (ArrayIndex != INDEX_NONE && State.Items.IsValidIndex(ArrayIndex) == false)
+	if (MissionSubsystem->Utility.IsValidMission(mID) == false) { return false; }
+
+	// Shared missions are only ever written to the group copy
+	UPDMissionTracker* OwningTracker = ResolveOwningTracker(mID);
+	if (OwningTracker != this)
+	{
+		return OwningTracker->SetMissionDatum(BaseTag, OverrideDatum);
+	}
+
+	// Resolved against the state the staged changes leave the mission in
+	if (Transaction.bIsOpen)
+	{
+		return StageMissionDatum(BaseTag, OverrideDatum);
+	}
+
+	// A raw state write stands for the one event that takes the mission there, anything further away needs its events applied in order
+	const EPDMissionState CurrentState = CopyCurrentDatum(mID).State.Current;
+	const EPDMissionEvent Step = FPDMissionStateMachine::ValidateStep(CurrentState, OverrideDatum.State.Current);
+	if (Step == EINVALID_EVENT)
 	{
-		mIDToReplIdMap.Remove(mID); // clear
-		ArrayIndex = INDEX_NONE;
+		UE_LOG(LogTemp, Warning, TEXT("UPDMissionTracker::SetMissionDatum -- Rejected, mID(%i) can not go from state(%i) to state(%i) in a single transition"), mID, CurrentState, OverrideDatum.State.Current.GetValue());
+		return false;
 	}
+
+	return TransitionMission(BaseTag, Step, OverrideDatum.HasDeadline() ? OverrideDatum.GetDeadlineSeconds() : 0.0);
+}
+
+void UPDMissionTracker::ApplyMissionDatum(const int32 mID, const FPDMissionNetDatum& OverrideDatum)
+{
+	int32 PageIndex = INDEX_NONE;
+	const int32 ItemIndex = FindItemIndex(mID, PageIndex);
 	
 	const FPDMissionState& NewState = OverrideDatum.State;
-	if (ArrayIndex != INDEX_NONE)
+	if (ItemIndex != INDEX_NONE)
 	{
-		State.Items[ArrayIndex].State.Current = NewState.Current;
-		State.Items[ArrayIndex].State.MissionConditionHandler = NewState.MissionConditionHandler;
-		State.MarkItemDirty(State.Items[ArrayIndex]);
+		FPDMissionNetDatum& Datum = GetCompound(PageIndex).Items[ItemIndex];
+		Datum.State.Current = NewState.Current;
+		Datum.State.MissionConditionHandle = NewState.MissionConditionHandle;
+		Datum.DeadlineTenths = OverrideDatum.DeadlineTenths;
+		CommitItemChange(mID, PageIndex, ItemIndex, false, true);
 	}
 	else
 	{
-		FPDMissionNetDatum& AddedDatum = State.Items.Add_GetRef(OverrideDatum);
-		State.MarkItemDirty(AddedDatum);
-		mIDToReplIdMap.Add(mID, AddedDatum.ReplicationID);
+		PageIndex = ResolvePageIndex(mID);
+		FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+		FPDMissionNetDatum& AddedDatum = Compound.Items.Add_GetRef(OverrideDatum);
+		AddedDatum.mID = mID;
+		CommitItemChange(mID, PageIndex, Compound.Items.Num() - 1, true, true);
 	}
+}
+
+FPDMissionNetDatum UPDMissionTracker::CopyCurrentDatum(const int32 mID) const
+{
+	const FPDMissionNetDatum* CurrentDatum = FindDatum(mID);
+	if (CurrentDatum != nullptr) { return *CurrentDatum; }
 
-	Server_OnMissionUpdated.Broadcast(DefaultData->Base.mID, NewState.Current);
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	return MissionSubsystem != nullptr ? MissionSubsystem->Utility.MakeDefaultDatum(mID) : FPDMissionNetDatum{};
+}
+
+bool UPDMissionTracker::BeginMissionTransaction()
+{
+	if (GetOwnerRole() != ROLE_Authority || Transaction.bIsOpen) { return false; }
+
+	Transaction.StagedEvents.Reset();
+	Transaction.StagedDeadlines.Reset();
+	Transaction.bIsOpen = true;
+	return true;
+}
 
+bool UPDMissionTracker::StageMissionDatum(const FGameplayTag& BaseTag, const FPDMissionNetDatum& Datum)
+{
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (Transaction.bIsOpen == false || MissionSubsystem == nullptr) { return false; }
+
+	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
+	if (mID == INDEX_NONE) { return false; }
+
+	// The event is only known once the events staged before it have been folded
+	Transaction.StagedEvents.Add(FPDMissionStagedEvent{mID, EINVALID_EVENT, Datum.State.Current, Datum.HasDeadline() ? Datum.GetDeadlineSeconds() : 0.0});
+	return true;
+}
+
+bool UPDMissionTracker::CommitMissionTransaction()
+{
+	if (Transaction.bIsOpen == false) { return false; }
+	Transaction.bIsOpen = false;
+
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr)
+	{
+		AbortMissionTransaction();
+		return false;
+	}
+
+	// Fold every staged event through the matrix on a scratch copy per mission before touching anything, a transaction is applied in full or not at all
+	TArray<FPDMissionNetDatum> ScratchDatums;
+	for (const FPDMissionStagedEvent& Staged : Transaction.StagedEvents)
+	{
+		if (MissionSubsystem->Utility.IsValidMission(Staged.mID) == false)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPDMissionTracker::CommitMissionTransaction -- Aborted, mID(%i) is not a valid mission"), Staged.mID);
+			AbortMissionTransaction();
+			return false;
+		}
+
+		FPDMissionNetDatum* ScratchDatum = ScratchDatums.FindByPredicate([&Staged](const FPDMissionNetDatum& Scratch) { return Scratch.mID == Staged.mID; });
+		if (ScratchDatum == nullptr)
+		{
+			ScratchDatum = &ScratchDatums.Add_GetRef(CopyCurrentDatum(Staged.mID));
+			ScratchDatum->mID = Staged.mID;
+		}
+
+		const EPDMissionState FromState = ScratchDatum->State.Current;
+		const EPDMissionEvent Event = Staged.Event != EINVALID_EVENT ? Staged.Event : FPDMissionStateMachine::ValidateStep(FromState, Staged.TargetState);
+		if (Event == EINVALID_EVENT || FPDMissionStateMachine::Apply(*ScratchDatum, Event, Staged.DeadlineSeconds) == false)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPDMissionTracker::CommitMissionTransaction -- Aborted, mID(%i) can not take event(%i) in state(%i)"), Staged.mID, static_cast<int32>(Event), FromState);
+			AbortMissionTransaction();
+			return false;
+		}
+
+		if (Event != EEventComplete) { continue; }
+		
+		// Tag conditions and condition expression alike, served from the compiled database if the mission came from there
+		if (MissionSubsystem->Utility.EvaluateMissionConditions(GetOwner(), Staged.mID) == false)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("UPDMissionTracker::CommitMissionTransaction -- Aborted, owner does not meet the conditions to complete mID(%i)"), Staged.mID);
+			AbortMissionTransaction();
+			return false;
+		}
+	}
+	Transaction.StagedEvents.Reset();
+
+	// Applied as one coalesced batch, one property dirty, one dirty mark per item and one batch broadcast
+	const bool bWasCoalescing = bCoalesceUpdates;
+	bCoalesceUpdates = true;
+	for (const FPDMissionNetDatum& ScratchDatum : ScratchDatums)
+	{
+		ApplyMissionDatum(ScratchDatum.mID, ScratchDatum);
+	}
+	bCoalesceUpdates = bWasCoalescing;
+
+	// Delayed transitions only start counting down once the changes they belong to have been applied
+	TArray<FPDMissionDeadlineEntry> StagedDeadlines = MoveTemp(Transaction.StagedDeadlines);
+	Transaction.StagedDeadlines.Reset();
+	for (const FPDMissionDeadlineEntry& Entry : StagedDeadlines)
+	{
+		ScheduleMissionDeadline(Entry.MissionBaseTag, Entry.OverwriteDatum, Entry.BranchBehaviour, Entry.Deadline);
+	}
+
+	if (bWasCoalescing == false)
+	{
+		FlushPendingChanges();
+	}
 	return true;
 }
 
-void UPDMissionTracker::FinalizeOverwriteRef(const FGameplayTag& MissionBaseTag, FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour)
+void UPDMissionTracker::AbortMissionTransaction()
 {
-	switch (BranchBehaviour.Type)
+	Transaction.StagedEvents.Reset();
+	Transaction.StagedDeadlines.Reset();
+	Transaction.bIsOpen = false;
+}
+
+bool UPDMissionTracker::FinalizeOverwriteRef(const FGameplayTag& MissionBaseTag, FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour)
+{
+	// Trigger goes to active, unlock goes to inactive. Leaving the pending state clears the deadline, clients stop counting down once this replicates
+	if (TransitionMission(MissionBaseTag, FPDMissionStateMachine::GetBranchEvent(BranchBehaviour.Type)) == false) { return false; }
+
+	// Hand the written state back to the caller, staged changes are only known once the transaction commits
+	if (Transaction.bIsOpen == false)
 	{
-	default: // Resolve default as trigger
-	case ETrigger:
-		// Go from locked/inactive to active
-		OverwriteDatum.State.Current = EPDMissionState::EActive;
-		break;
-	case EUnlock:
-		// Go from locked to inactive
-			OverwriteDatum.State.Current = EPDMissionState::EInactive;
-		break;
+		OverwriteDatum = ResolveOwningTracker(OverwriteDatum.mID)->CopyCurrentDatum(OverwriteDatum.mID);
 	}
-	SetMissionDatum(MissionBaseTag, OverwriteDatum);	
+	return true;
 }
 
 void UPDMissionTracker::FinalizeOverwriteCopy(FGameplayTag MissionBaseTag, FPDMissionNetDatum OverwriteDatum, FPDMissionBranchBehaviour BranchBehaviour)
@@ -79,8 +340,98 @@ void UPDMissionTracker::FinalizeOverwriteCopy(FGameplayTag MissionBaseTag, FPDMi
 	FinalizeOverwriteRef(MissionBaseTag, OverwriteDatum, BranchBehaviour);
 }
 
+void UPDMissionTracker::ScheduleMissionDeadline(const FGameplayTag& MissionBaseTag, const FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour, const double Deadline)
+{
+	if (GetOwnerRole() != ROLE_Authority) { return; }
+
+	// Scheduled together with the rest of the transaction, or dropped with it
+	if (Transaction.bIsOpen)
+	{
+		Transaction.StagedDeadlines.Add(FPDMissionDeadlineEntry{Deadline, MissionBaseTag, OverwriteDatum, BranchBehaviour});
+		return;
+	}
+
+	const double Earliest = GetEarliestDeadline();
+	const bool bNewEarliest = Earliest < 0.0 || Deadline < Earliest;
+	DeadlineHeap.HeapPush(FPDMissionDeadlineEntry{Deadline, MissionBaseTag, OverwriteDatum, BranchBehaviour});
+	
+	// Only the earliest deadline has a timer, later ones are picked up when it fires
+	if (bNewEarliest) { ArmDeadlineTimer(); }
+}
+
+void UPDMissionTracker::OnDeadlineReached()
+{
+	const double Now = UPDMissionStatics::GetServerWorldTime(this);
+	while (DeadlineHeap.IsEmpty() == false && DeadlineHeap.HeapTop().Deadline <= Now + KINDA_SMALL_NUMBER)
+	{
+		FPDMissionDeadlineEntry Entry;
+		DeadlineHeap.HeapPop(Entry);
+		FinalizeOverwriteRef(Entry.MissionBaseTag, Entry.OverwriteDatum, Entry.BranchBehaviour);
+	}
+
+	// Expiries are rounded up to the next tenth, the same way the datums deadline is
+	const uint32 NowTenths = static_cast<uint32>(FMath::FloorToDouble((Now + KINDA_SMALL_NUMBER) * 10.0));
+	while (CooldownHeap.IsEmpty() == false && CooldownHeap.HeapTop().ExpiryTenths <= NowTenths)
+	{
+		FPDMissionCooldownEntry Entry;
+		CooldownHeap.HeapPop(Entry);
+		ExpireMissionCooldown(Entry);
+	}
+	ArmDeadlineTimer();
+}
+
+void UPDMissionTracker::ArmDeadlineTimer()
+{
+	const UWorld* World = GetWorld();
+	const double Earliest = GetEarliestDeadline();
+	if (World == nullptr || Earliest < 0.0) { return; }
+
+	const float Delay = FMath::Max(static_cast<float>(Earliest - UPDMissionStatics::GetServerWorldTime(this)), KINDA_SMALL_NUMBER);
+	World->GetTimerManager().SetTimer(DeadlineTimerHandle, this, &UPDMissionTracker::OnDeadlineReached, Delay, false);
+}
+
+double UPDMissionTracker::GetEarliestDeadline() const
+{
+	double Earliest = DeadlineHeap.IsEmpty() ? -1.0 : DeadlineHeap.HeapTop().Deadline;
+	if (CooldownHeap.IsEmpty() == false)
+	{
+		const double CooldownExpiry = CooldownHeap.HeapTop().ExpiryTenths / 10.0;
+		Earliest = Earliest < 0.0 ? CooldownExpiry : FMath::Min(Earliest, CooldownExpiry);
+	}
+	return Earliest;
+}
 
-TArray<FPDMissionNetDatum>& UPDMissionTracker::GetUserMissions()
+void UPDMissionTracker::ScheduleMissionCooldown(const int32 mID, const double ExpirySeconds)
+{
+	if (GetOwnerRole() != ROLE_Authority) { return; }
+
+	const FPDMissionCooldownEntry Entry{FPDMissionNetDatum::EncodeDeadline(ExpirySeconds), mID};
+
+	const double Earliest = GetEarliestDeadline();
+	const bool bNewEarliest = Earliest < 0.0 || ExpirySeconds < Earliest;
+	CooldownHeap.HeapPush(Entry);
+	if (bNewEarliest) { ArmDeadlineTimer(); }
+}
+
+void UPDMissionTracker::ExpireMissionCooldown(const FPDMissionCooldownEntry& Entry)
+{
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	const FPDMissionNetDatum* Datum = FindDatum(Entry.mID);
+	if (Datum == nullptr || MissionSubsystem == nullptr || MissionSubsystem->Utility.IsValidMission(Entry.mID) == false || Datum->DeadlineTenths != Entry.ExpiryTenths) { return; }
+
+	TransitionMission(MissionSubsystem->Utility.GetMissionBaseTag(Entry.mID), EEventReset);
+}
+
+float UPDMissionTracker::GetMissionTimeRemaining(const FGameplayTag& BaseTag) const
+{
+	const FPDMissionNetDatum* Datum = GetDatum(BaseTag);
+	if (Datum == nullptr || Datum->HasDeadline() == false) { return -1.0f; }
+
+	return FMath::Max(static_cast<float>(Datum->GetDeadlineSeconds() - UPDMissionStatics::GetServerWorldTime(this)), 0.0f);
+}
+
+
+TArray<FPDMissionNetDatum> UPDMissionTracker::GetUserMissions() const
 {
 	// If any clients		
 	// LastAccumulatedStatCompounds.Append(State.Items);
@@ -93,43 +444,567 @@ TArray<FPDMissionNetDatum>& UPDMissionTracker::GetUserMissions()
 	// {
 	// 	LastAccumulatedStatCompounds.Append(PrivateProgress.Items);
 	// }
-		
-	return State.Items;
+
+	// With 'bPageByMissionType' set the root holds no missions at all, every page needs to be gathered
+	TArray<FPDMissionNetDatum> UserMissions;
+	for (int32 PageIndex = INDEX_NONE; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && Pages[PageIndex] == nullptr) { continue; }
+		UserMissions.Append(GetCompound(PageIndex).Items);
+	}
+	return UserMissions;
 }
 
 bool UPDMissionTracker::AddMissionDatum(const FPDMissionNetDatum& Mission)
 {
-	int32 ArrayIndex = mIDToReplIdMap.Contains(Mission.mID) ? *mIDToReplIdMap.Find(Mission.mID) -1 : INDEX_NONE;
-	if (ArrayIndex != INDEX_NONE && State.Items.IsValidIndex(ArrayIndex) == false)
+	int32 PageIndex = INDEX_NONE;
+	const int32 ItemIndex = FindItemIndex(Mission.mID, PageIndex);
+	if (ItemIndex != INDEX_NONE)
+	{
+		GetCompound(PageIndex).Items[ItemIndex].State = Mission.State;
+		CommitItemChange(Mission.mID, PageIndex, ItemIndex, false, false);
+		return true;
+	}
+	
+	PageIndex = ResolvePageIndex(Mission.mID);
+	FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+	Compound.Items.Add(Mission);
+	CommitItemChange(Mission.mID, PageIndex, Compound.Items.Num() - 1, true, false);
+
+	return true;
+}
+
+void UPDMissionTracker::RemoveMissionRange(const int32 FirstMID, const int32 LastMID)
+{
+	if (GetOwnerRole() != ROLE_Authority || FirstMID > LastMID) { return; }
+
+	// Staged changes are addressed by item, flush them before any item moves
+	FlushPendingChanges();
+
+	for (int32 PageIndex = INDEX_NONE; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && Pages[PageIndex] == nullptr) { continue; }
+
+		FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+		const int32 NumRemoved = Compound.Items.RemoveAll([FirstMID, LastMID](const FPDMissionNetDatum& Datum) { return Datum.mID >= FirstMID && Datum.mID <= LastMID; });
+		if (NumRemoved == 0) { continue; }
+
+		Compound.MarkArrayDirty();
+		MarkCompoundDirty(PageIndex);
+	}
+
+	for (int32 mID = FMath::Max(FirstMID, 1); mID <= LastMID; mID++)
+	{
+		UpdateStateIndex(mID, EPDMissionState::EINVALID_STATE);
+		mIDToReplIdMap.Remove(mID);
+	}
+	InvalidateHandleLookup();
+}
+
+void UPDMissionTracker::CommitItemChange(const int32 mID, const int32 PageIndex, const int32 ItemIndex, const bool bItemAdded, const bool bBroadcast)
+{
+	FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+	FPDMissionNetDatum& Datum = Compound.Items[ItemIndex];
+	
+	// Kept in sync right away, even while coalescing, server queries need to see the current state
+	UpdateStateIndex(mID, Datum.State.Current);
+	if (bItemAdded)
+	{
+		// New items need their replication ID right away, the mID lookup is keyed on it
+		Compound.MarkItemDirty(Datum);
+		mIDToReplIdMap.Add(mID, Datum.ReplicationID);
+		UpdateHandleLookup(mID, PageIndex, ItemIndex);
+	}
+	
+	if (bCoalesceUpdates == false)
+	{
+		if (ShouldThrottle(mID)) { ThrottleItemChange(mID); }
+		else { MarkCompoundDirty(PageIndex); }
+		if (bItemAdded == false) { Compound.MarkItemDirty(Datum); }
+		if (bBroadcast) { Server_OnMissionUpdated.Broadcast(mID, Datum.State.Current); }
+		return;
+	}
+
+	if (PendingItemFlags.Num() < mID)
+	{
+		PendingItemFlags.SetNumZeroed(mID);
+	}
+	
+	uint8& Flags = PendingItemFlags[mID - 1];
+	if ((Flags & EPendingItem_Staged) == 0)
+	{
+		PendingMIDs.Add(mID);
+	}
+	Flags |= EPendingItem_Staged;
+	Flags |= bItemAdded ? EPendingItem_None : EPendingItem_MarkDirty;
+	Flags |= bBroadcast ? EPendingItem_Broadcast : EPendingItem_None;
+
+	SetComponentTickEnabled(true);
+}
+
+void UPDMissionTracker::FlushPendingChanges()
+{
+	SetComponentTickEnabled(HasThrottledChanges());
+	if (PendingMIDs.IsEmpty()) { return; }
+
+	// Listeners may stage new changes while being broadcast to, those land in 'PendingMIDs' again and are picked up by the next round
+	TArray<int32> FlushedMIDs;
+	TArray<int32> FlushingMIDs;
+	while (PendingMIDs.IsEmpty() == false)
+	{
+		Swap(FlushingMIDs, PendingMIDs);
+		PendingMIDs.Reset();
+		
+		for (const int32 mID : FlushingMIDs)
+		{
+			// Cleared before broadcasting, so a change staged by a listener is tracked anew
+			const uint8 Flags = PendingItemFlags[mID - 1];
+			PendingItemFlags[mID - 1] = EPendingItem_None;
+
+			int32 PageIndex = INDEX_NONE;
+			const int32 ItemIndex = FindItemIndex(mID, PageIndex);
+			if (ItemIndex == INDEX_NONE) { continue; }
+
+			// Only the pages that actually changed get marked, untouched pages cost nothing to replicate
+			FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+			FPDMissionNetDatum& Datum = Compound.Items[ItemIndex];
+			if (ShouldThrottle(mID)) { ThrottleItemChange(mID); }
+			else { MarkCompoundDirty(PageIndex); }
+			if ((Flags & EPendingItem_MarkDirty) != 0) { Compound.MarkItemDirty(Datum); }
+			if ((Flags & EPendingItem_Broadcast) == 0) { continue; }
+			
+			// Listeners only see the final state of the frame
+			FlushedMIDs.AddUnique(mID);
+			Server_OnMissionUpdated.Broadcast(mID, Datum.State.Current);
+		}
+	}
+
+	if (FlushedMIDs.IsEmpty() == false)
+	{
+		Server_OnMissionsUpdatedBatch.Broadcast(FlushedMIDs);
+	}
+}
+
+void UPDMissionTracker::SetMissionFocus(const FGameplayTag& BaseTag, const bool bFocused)
+{
+	if (GetOwnerRole() != ROLE_Authority) { return; }
+
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return; }
+
+	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
+	if (mID <= 0) { return; }
+
+	if (FocusedMissions.Num() < mID)
+	{
+		FocusedMissions.Add(false, mID - FocusedMissions.Num());
+	}
+	FocusedMissions[mID - 1] = bFocused;
+
+	// A mission that gains focus while it has a throttled change sends it right away instead of waiting for budget
+	if (bFocused == false || ThrottledQueued.IsValidIndex(mID - 1) == false || ThrottledQueued[mID - 1] == false) { return; }
+	ThrottledQueued[mID - 1] = false;
+
+	int32 PageIndex = INDEX_NONE;
+	if (FindItemIndex(mID, PageIndex) == INDEX_NONE) { return; }
+	MarkCompoundDirty(PageIndex);
+}
+
+void UPDMissionTracker::ServerSetMissionFocus_Implementation(FGameplayTag BaseTag, bool bFocused)
+{
+	SetMissionFocus(BaseTag, bFocused);
+}
+
+bool UPDMissionTracker::IsMissionFocused(const int32 mID) const
+{
+	return FocusedMissions.IsValidIndex(mID - 1) && FocusedMissions[mID - 1];
+}
+
+void UPDMissionTracker::RequestFullState()
+{
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	UPDMissionTracker* Requester = MissionSubsystem != nullptr ? MissionSubsystem->Utility.GetLocallyOwnedTracker() : nullptr;
+	if (Requester == nullptr)
 	{
-		mIDToReplIdMap.Remove(Mission.mID); // clear
-		ArrayIndex = INDEX_NONE;
+		UE_LOG(LogTemp, Error, TEXT("UPDMissionTracker::RequestFullState -- Snapshot does not match the local missions and this client owns no tracker to request the full state through, items only arrive once they change"));
+		return;
 	}
+	Requester->ServerRequestFullState(this);
+}
+
+void UPDMissionTracker::ServerRequestFullState_Implementation(UPDMissionTracker* TargetTracker)
+{
+	if (TargetTracker != nullptr) { TargetTracker->ScheduleFullState(); }
+}
+
+void UPDMissionTracker::ServerReportDatabaseChecksum_Implementation(const uint32 Checksum)
+{
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr || GetOwner() == nullptr) { return; }
+
+	MissionSubsystem->Utility.SetConnectionChecksum(GetOwner()->GetNetConnection(), Checksum);
+}
+
+void UPDMissionTracker::ScheduleFullState()
+{
+	const UWorld* World = GetWorld();
+	if (GetOwnerRole() != ROLE_Authority || World == nullptr) { return; }
+
+	// Every request made before the resend goes out is served by it
+	FTimerManager& TimerManager = World->GetTimerManager();
+	if (TimerManager.IsTimerActive(FullStateTimerHandle)) { return; }
+
+	const double Delay = LastFullStateResendTime < 0.0 ? 0.0 : LastFullStateResendTime + FullStateResendInterval - World->GetTimeSeconds();
+	if (Delay <= 0.0)
+	{
+		ResendFullState();
+		return;
+	}
+	TimerManager.SetTimer(FullStateTimerHandle, this, &UPDMissionTracker::ResendFullState, static_cast<float>(Delay), false);
+}
+
+void UPDMissionTracker::ResendFullState()
+{
+	const UWorld* World = GetWorld();
+	LastFullStateResendTime = World != nullptr ? World->GetTimeSeconds() : 0.0;
+
+	// Staged changes are addressed by item, flush them before re-marking
+	FlushPendingChanges();
+
+	// New replication keys on every item, each connection gets the items its base state does not match. Clients that dropped a snapshot add them back
+	for (int32 PageIndex = INDEX_NONE; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && Pages[PageIndex] == nullptr) { continue; }
+
+		FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+		for (FPDMissionNetDatum& Item : Compound.Items) { Compound.MarkItemDirty(Item); }
+		MarkCompoundDirty(PageIndex);
+	}
+}
+
+bool UPDMissionTracker::HasThrottledChanges() const
+{
+	return ThrottledHead < ThrottledMIDs.Num();
+}
+
+bool UPDMissionTracker::ShouldThrottle(const int32 mID) const
+{
+	return bThrottleBackgroundMissions && IS_PUSH_MODEL_ENABLED() && IsMissionFocused(mID) == false;
+}
+
+void UPDMissionTracker::ThrottleItemChange(const int32 mID)
+{
+	if (ThrottledQueued.Num() < mID)
+	{
+		ThrottledQueued.Add(false, mID - ThrottledQueued.Num());
+	}
+	if (ThrottledQueued[mID - 1]) { return; }
+
+	ThrottledQueued[mID - 1] = true;
+	ThrottledMIDs.Add(mID);
+	SetComponentTickEnabled(true);
+}
+
+void UPDMissionTracker::DrainThrottledChanges()
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr || HasThrottledChanges() == false) { return; }
+
+	// Blueprints can write past the clamps, the burst always fits at least one update so the queue keeps draining
+	const int32 BytesPerUpdate = FMath::Max(BackgroundBytesPerUpdate, 1);
+	const int32 BurstBytes = FMath::Max(BackgroundBurstBytes, BytesPerUpdate);
+	const int32 BytesPerSecond = FMath::Max(BackgroundBytesPerSecond, 1);
+	
+	// Token bucket, refilled by the time since the last drain so idle time is not lost while not ticking
+	const double Now = World->GetTimeSeconds();
+	ThrottleBudgetBytes = FMath::Min(ThrottleBudgetBytes + (Now - LastThrottleRefillTime) * BytesPerSecond, static_cast<double>(BurstBytes));
+	LastThrottleRefillTime = Now;
+
+	while (HasThrottledChanges() && ThrottleBudgetBytes >= BytesPerUpdate)
+	{
+		const int32 mID = ThrottledMIDs[ThrottledHead++];
+		
+		// Already sent, the mission gained focus while queued
+		if (ThrottledQueued[mID - 1] == false) { continue; }
+		ThrottledQueued[mID - 1] = false;
+
+		int32 PageIndex = INDEX_NONE;
+		if (FindItemIndex(mID, PageIndex) == INDEX_NONE) { continue; }
+		
+		MarkCompoundDirty(PageIndex);
+		ThrottleBudgetBytes -= BytesPerUpdate;
+	}
+
+	if (HasThrottledChanges() == false)
+	{
+		ThrottledMIDs.Reset();
+		ThrottledHead = 0;
+	}
+}
+
+FPDMissionNetDataCompound& UPDMissionTracker::GetCompound(const int32 PageIndex)
+{
+	return Pages.IsValidIndex(PageIndex) && Pages[PageIndex] != nullptr ? Pages[PageIndex]->State : State;
+}
+
+const FPDMissionNetDataCompound& UPDMissionTracker::GetCompound(const int32 PageIndex) const
+{
+	return Pages.IsValidIndex(PageIndex) && Pages[PageIndex] != nullptr ? Pages[PageIndex]->State : State;
+}
 
+void UPDMissionTracker::MarkCompoundDirty(const int32 PageIndex)
+{
+	if (Pages.IsValidIndex(PageIndex) && Pages[PageIndex] != nullptr)
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTrackerPage, State, Pages[PageIndex]);
+		return;
+	}
 	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, State, this);
-	if (ArrayIndex != INDEX_NONE)
+}
+
+int32 UPDMissionTracker::FindItemIndex(const int32 mID, int32& OutPageIndex) const
+{
+	OutPageIndex = INDEX_NONE;
+	if (mID <= 0) { return INDEX_NONE; }
+
+	// Replication IDs stop matching item indices once items are removed, and clients never see the IDs being handed out, so go through the dense lookup
+	EnsureHandleLookup();
+	OutPageIndex = DensePageIndices.IsValidIndex(mID - 1) ? DensePageIndices[mID - 1] : INDEX_NONE;
+	const int32 ItemIndex = DenseItemIndices.IsValidIndex(mID - 1) ? DenseItemIndices[mID - 1] : INDEX_NONE;
+
+	const TArray<FPDMissionNetDatum>& Items = GetCompound(OutPageIndex).Items;
+	return Items.IsValidIndex(ItemIndex) && Items[ItemIndex].mID == mID ? ItemIndex : INDEX_NONE;
+}
+
+const FPDMissionNetDatum* UPDMissionTracker::FindDatum(const int32 mID) const
+{
+	if (GroupTracker != nullptr && GroupTracker != this && IsSharedMission(mID))
 	{
-		State.Items[ArrayIndex].State = Mission.State;
-		State.MarkItemDirty(State.Items[ArrayIndex]);
-		return true;
+		return GroupTracker->FindDatum(mID);
 	}
 	
-	FPDMissionNetDatum& AddedDatum = State.Items.Add_GetRef(Mission);
-	State.MarkItemDirty(AddedDatum);
-	mIDToReplIdMap.Add(Mission.mID, AddedDatum.ReplicationID);
+	int32 PageIndex = INDEX_NONE;
+	const int32 ItemIndex = FindItemIndex(mID, PageIndex);
+	return ItemIndex != INDEX_NONE ? &GetCompound(PageIndex).Items[ItemIndex] : nullptr;
+}
 
-	return true;
+int32 UPDMissionTracker::ResolvePageIndex(const int32 mID)
+{
+	if (bPageByMissionType == false || mID <= 0) { return INDEX_NONE; }
+	if (DensePageIndices.IsValidIndex(mID - 1) && DensePageIndices[mID - 1] != INDEX_NONE) { return DensePageIndices[mID - 1]; }
+
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr || MissionSubsystem->Utility.IsValidMission(mID) == false) { return INDEX_NONE; }
+
+	const int32 PageIndex = FindOrAddPage(MissionSubsystem->Utility.GetMissionTypeTag(mID));
+	GrowDenseLookups(mID);
+	DensePageIndices[mID - 1] = PageIndex;
+	return PageIndex;
 }
 
-const FPDMissionNetDatum* UPDMissionTracker::GetDatum(int32 SID) const
+int32 UPDMissionTracker::FindOrAddPage(const FGameplayTag& PageTag)
+{
+	const int32* ExistingPage = PageIndexByTag.Find(PageTag);
+	if (ExistingPage != nullptr) { return *ExistingPage; }
+
+	UPDMissionTrackerPage* NewPage = NewObject<UPDMissionTrackerPage>(this);
+	NewPage->PageTag = PageTag;
+	NewPage->State.OwnerTracker = this;
+	AddReplicatedSubObject(NewPage);
+	
+	const int32 PageIndex = Pages.Add(NewPage);
+	PageIndexByTag.Add(PageTag, PageIndex);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, Pages, this);
+	return PageIndex;
+}
+
+void UPDMissionTracker::OnRep_Pages()
+{
+	InvalidateHandleLookup();
+}
+
+void UPDMissionTracker::SetGroupTracker(UPDMissionTracker* NewGroupTracker)
+{
+	if (GetOwnerRole() != ROLE_Authority || bIsGroupTracker || GroupTracker == NewGroupTracker) { return; }
+
+	// Staged changes are addressed by item, flush them before any item moves
+	FlushPendingChanges();
+
+	// The group keeps its progress for the remaining members, the leaving member continues from a copy
+	if (GroupTracker != nullptr) { CopySharedMissionsFrom(*GroupTracker); }
+
+	GroupTracker = NewGroupTracker;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, GroupTracker, this);
+
+	if (GroupTracker != nullptr) { HandOverSharedMissionsTo(*GroupTracker); }
+	InvalidateHandleLookup();
+}
+
+void UPDMissionTracker::SetSharedMissionTags(const TArray<FGameplayTag>& NewSharedMissionTags)
+{
+	if (GetOwnerRole() != ROLE_Authority) { return; }
+
+	SharedMissionTags = NewSharedMissionTags;
+	SharedMissionMaskGeneration = INDEX_NONE;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, SharedMissionTags, this);
+}
+
+void UPDMissionTracker::OnRep_SharedMissionTags()
+{
+	SharedMissionMaskGeneration = INDEX_NONE;
+}
+
+void UPDMissionTracker::CopySharedMissionsFrom(const UPDMissionTracker& SourceTracker)
+{
+	for (int32 PageIndex = INDEX_NONE; PageIndex < SourceTracker.Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && SourceTracker.Pages[PageIndex] == nullptr) { continue; }
+
+		for (const FPDMissionNetDatum& SourceDatum : SourceTracker.GetCompound(PageIndex).Items)
+		{
+			if (SourceTracker.IsSharedMission(SourceDatum.mID) == false) { continue; }
+
+			// Replication IDs belong to the source array, the copy gets its own
+			FPDMissionNetDatum CopiedDatum{SourceDatum.mID, SourceDatum.State};
+			CopiedDatum.TickSettings = SourceDatum.TickSettings;
+			CopiedDatum.DeadlineTenths = SourceDatum.DeadlineTenths;
+			ApplyMissionDatum(SourceDatum.mID, CopiedDatum);
+		}
+	}
+}
+
+void UPDMissionTracker::HandOverSharedMissionsTo(UPDMissionTracker& TargetTracker)
+{
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return; }
+
+	TArray<int32> SharedMIDs;
+	for (int32 PageIndex = INDEX_NONE; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && Pages[PageIndex] == nullptr) { continue; }
+
+		FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+		for (const FPDMissionNetDatum& LocalDatum : Compound.Items)
+		{
+			if (IsSharedMission(LocalDatum.mID) == false) { continue; }
+			SharedMIDs.Add(LocalDatum.mID);
+
+			// Progress made alone only carries over if the group has not progressed the mission yet
+			const FPDMissionNetDatum* GroupDatum = TargetTracker.FindDatum(LocalDatum.mID);
+			const bool bGroupHasProgress = GroupDatum != nullptr && MissionSubsystem->Utility.IsDefaultDatum(*GroupDatum) == false;
+			if (bGroupHasProgress || (GroupDatum != nullptr && MissionSubsystem->Utility.IsDefaultDatum(LocalDatum))) { continue; }
+
+			FPDMissionNetDatum HandedDatum{LocalDatum.mID, LocalDatum.State};
+			HandedDatum.TickSettings = LocalDatum.TickSettings;
+			HandedDatum.DeadlineTenths = LocalDatum.DeadlineTenths;
+			TargetTracker.ApplyMissionDatum(LocalDatum.mID, HandedDatum);
+		}
+
+		const int32 NumRemoved = Compound.Items.RemoveAll([this](const FPDMissionNetDatum& Datum) { return IsSharedMission(Datum.mID); });
+		if (NumRemoved == 0) { continue; }
+
+		Compound.MarkArrayDirty();
+		MarkCompoundDirty(PageIndex);
+	}
+
+	for (const int32 mID : SharedMIDs)
+	{
+		UpdateStateIndex(mID, EPDMissionState::EINVALID_STATE);
+		mIDToReplIdMap.Remove(mID);
+	}
+}
+
+bool UPDMissionTracker::IsSharedMission(const int32 mID) const
+{
+	// Members follow the tags of their group, so a member that is not in a group shares nothing
+	if (bIsGroupTracker == false) { return GroupTracker != nullptr && GroupTracker != this && GroupTracker->IsSharedMission(mID); }
+	if (SharedMissionTags.IsEmpty() || mID <= 0) { return false; }
+
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return false; }
+
+	// Tag matching is hierarchical and comparatively slow, so it is resolved once per database generation
+	const FPDMissionUtility& Utility = MissionSubsystem->Utility;
+	if (SharedMissionMaskGeneration != Utility.GetDatabaseGeneration())
+	{
+		const FGameplayTagContainer SharedTags = FGameplayTagContainer::CreateFromArray(SharedMissionTags);
+		SharedMissionMask.Init(false, Utility.GetNumDenseMissions());
+		for (int32 DenseIndex = 0; DenseIndex < SharedMissionMask.Num(); DenseIndex++)
+		{
+			SharedMissionMask[DenseIndex] = Utility.IsValidMission(DenseIndex + 1) && Utility.GetMissionBaseTag(DenseIndex + 1).MatchesAny(SharedTags);
+		}
+		SharedMissionMaskGeneration = Utility.GetDatabaseGeneration();
+	}
+	return SharedMissionMask.IsValidIndex(mID - 1) && SharedMissionMask[mID - 1];
+}
+
+bool UPDMissionTracker::ShouldTrackMission(const int32 mID) const
 {
-	const int32* ReplicationID = mIDToReplIdMap.Find(SID);
-	if (ReplicationID == nullptr) { return nullptr; }
+	return IsSharedMission(mID) == bIsGroupTracker;
+}
+
+UPDMissionTracker* UPDMissionTracker::ResolveOwningTracker(const int32 mID)
+{
+	return GroupTracker != nullptr && GroupTracker != this && IsSharedMission(mID) ? GroupTracker : this;
+}
+
+void UPDMissionTracker::UpdateStateIndex(const int32 mID, const EPDMissionState NewState)
+{
+	if (ActorID == INDEX_NONE || mID <= 0 || GetOwnerRole() != ROLE_Authority) { return; }
+
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return; }
+
+	if (IndexedStates.Num() < mID)
+	{
+		const int32 OldNum = IndexedStates.Num();
+		IndexedStates.SetNumUninitialized(mID);
+		for (int32 FillIndex = OldNum; FillIndex < mID; FillIndex++) { IndexedStates[FillIndex] = EPDMissionState::EINVALID_STATE; }
+	}
+
+	uint8& IndexedState = IndexedStates[mID - 1];
+	if (IndexedState == NewState) { return; }
 	
-	const int32 ArrayIndex = *ReplicationID - 1;
-	if (State.Items.IsValidIndex(ArrayIndex) == false) { return nullptr; }
+	MissionSubsystem->Utility.UpdateMissionStateIndex(ActorID, mID, static_cast<EPDMissionState>(IndexedState), NewState);
+	IndexedState = NewState;
+
+	// Listen servers and standalone, clients preload as the change replicates
+	PreloadUpcomingMissions(mID, NewState);
+}
+
+void UPDMissionTracker::PreloadUpcomingMissions(const int32 mID, const EPDMissionState NewState) const
+{
+	const AActor* Owner = GetOwner();
+	if (NewState != EPDMissionState::EActive || Owner == nullptr || Owner->HasLocalNetOwner() == false) { return; }
+
+	UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr) { return; }
 	
-	return &State.Items[ArrayIndex];
+	MissionSubsystem->Utility.PreloadBranchTargets(Owner, mID);
+}
+
+void UPDMissionTracker::ClearStateIndex()
+{
+	for (int32 DenseIndex = 0; DenseIndex < IndexedStates.Num(); DenseIndex++)
+	{
+		UpdateStateIndex(DenseIndex + 1, EPDMissionState::EINVALID_STATE);
+	}
+	IndexedStates.Reset();
+}
+
+bool UPDMissionTracker::HasAnyItems() const
+{
+	if (State.Items.IsEmpty() == false) { return true; }
+	for (const UPDMissionTrackerPage* Page : Pages)
+	{
+		if (Page != nullptr && Page->State.Items.IsEmpty() == false) { return true; }
+	}
+	return false;
+}
+
+const FPDMissionNetDatum* UPDMissionTracker::GetDatum(int32 SID) const
+{
+	return FindDatum(SID);
 }
 
 const FPDMissionNetDatum* UPDMissionTracker::GetDatum(const FGameplayTag& BaseTag) const
@@ -137,13 +1012,178 @@ const FPDMissionNetDatum* UPDMissionTracker::GetDatum(const FGameplayTag& BaseTa
 	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
 	if (MissionSubsystem == nullptr) { return nullptr; }
 	
-	const FPDMissionRow* Data = MissionSubsystem->Utility.GetDefaultBaseViaTag(BaseTag);
-	if (Data == nullptr) { return nullptr; }
+	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
+	if (mID == INDEX_NONE) { return nullptr; }
+
+	return FindDatum(mID);
+}
+
+const FPDMissionNetDatum* UPDMissionTracker::GetDatum(const FPDMissionHandle& Handle) const
+{
+	if (Handle.IsSet() == false) { return nullptr; }
+
+	// Always checked against the current generation, the lookup may itself still be on the same stale generation as the handle
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (MissionSubsystem == nullptr || MissionSubsystem->Utility.IsValidHandle(Handle) == false) { return nullptr; }
+
+	if (GroupTracker != nullptr && GroupTracker != this && IsSharedMission(Handle.Index + 1))
+	{
+		return GroupTracker->GetDatum(Handle);
+	}
+
+	// Slow path, only taken when the lookup is stale. The handle is known to be current at this point
+	if (Handle.Generation != HandleGeneration)
+	{
+		RebuildHandleLookup(Handle.Generation);
+	}
+
+	const int32 ItemIndex = DenseItemIndices.IsValidIndex(Handle.Index) ? DenseItemIndices[Handle.Index] : INDEX_NONE;
+	const int32 PageIndex = DensePageIndices.IsValidIndex(Handle.Index) ? DensePageIndices[Handle.Index] : INDEX_NONE;
+	const FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+	if (Compound.Items.IsValidIndex(ItemIndex) == false) { return nullptr; }
+
+	return &Compound.Items[ItemIndex];
+}
+
+TEnumAsByte<EPDMissionState> UPDMissionTracker::GetStateSelectorViaHandle(const FPDMissionHandle& Handle) const
+{
+	const FPDMissionNetDatum* Datum = GetDatum(Handle);
+	return Datum != nullptr ? Datum->State.Current : EPDMissionState::EINVALID_STATE;
+}
+
+void UPDMissionTracker::RebuildHandleLookup(int32 Generation) const
+{
+	DenseItemIndices.Reset();
+
+	// Also rebuilds the page lookup, clients never resolve pages themselves and only learn them from here
+	DensePageIndices.Reset();
+	for (int32 PageIndex = INDEX_NONE; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (PageIndex != INDEX_NONE && Pages[PageIndex] == nullptr) { continue; }
+		
+		const TArray<FPDMissionNetDatum>& Items = GetCompound(PageIndex).Items;
+		for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ItemIndex++)
+		{
+			const int32 DenseIndex = Items[ItemIndex].mID - 1;
+			if (DenseIndex < 0) { continue; }
+
+			GrowDenseLookups(DenseIndex + 1);
+			DenseItemIndices[DenseIndex] = ItemIndex;
+			DensePageIndices[DenseIndex] = PageIndex;
+		}
+	}
+	HandleGeneration = Generation;
+}
+
+void UPDMissionTracker::EnsureHandleLookup() const
+{
+	if (HandleGeneration != INDEX_NONE) { return; }
+
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	RebuildHandleLookup(MissionSubsystem != nullptr ? MissionSubsystem->Utility.GetDatabaseGeneration() : 0);
+}
+
+void UPDMissionTracker::GrowDenseLookups(const int32 Num) const
+{
+	while (DenseItemIndices.Num() < Num) { DenseItemIndices.Add(INDEX_NONE); }
+	while (DensePageIndices.Num() < Num) { DensePageIndices.Add(INDEX_NONE); }
+}
+
+void UPDMissionTracker::UpdateHandleLookup(const int32 mID, const int32 PageIndex, const int32 ItemIndex)
+{
+	if (HandleGeneration == INDEX_NONE || mID <= 0) { return; }
+
+	// Grown in place, item lookups go through here so it needs to stay current while items are added one at a time
+	GrowDenseLookups(mID);
+	DenseItemIndices[mID - 1] = ItemIndex;
+	DensePageIndices[mID - 1] = PageIndex;
+}
+
+bool UPDMissionTracker::InitializeFromTemplate(const TArray<FPDMissionNetDatum>& Template)
+{
+	if (HasAnyItems()) { return false; }
+
+	mIDToReplIdMap.Reset();
+	mIDToReplIdMap.Reserve(Template.Num());
+	if (bPageByMissionType == false)
+	{
+		State.Items.Reserve(Template.Num());
+	}
+	
+	for (const FPDMissionNetDatum& TemplateDatum : Template)
+	{
+		if (ShouldTrackMission(TemplateDatum.mID) == false) { continue; }
+		
+		const int32 PageIndex = ResolvePageIndex(TemplateDatum.mID);
+		FPDMissionNetDataCompound& Compound = GetCompound(PageIndex);
+		FPDMissionNetDatum& Datum = Compound.Items.Add_GetRef(TemplateDatum);
+		Compound.MarkItemDirty(Datum);
+		mIDToReplIdMap.Add(Datum.mID, Datum.ReplicationID);
+		UpdateStateIndex(Datum.mID, Datum.State.Current);
+	}
+	
+	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, State, this);
+	for (int32 PageIndex = 0; PageIndex < Pages.Num(); PageIndex++)
+	{
+		MarkCompoundDirty(PageIndex);
+	}
+	InvalidateHandleLookup();
+	return true;
+}
+
+void UPDMissionTracker::ReleaseStateBlock(FPDMissionTrackerStateBlock& OutBlock)
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(UPDMissionTracker, State, this);
+	
+	// Moving hands over the allocations, resetting afterwards keeps their capacity
+	OutBlock.Items = MoveTemp(State.Items);
+	OutBlock.Items.Reset();
+	OutBlock.mIDToReplIdMap = MoveTemp(mIDToReplIdMap);
+	OutBlock.mIDToReplIdMap.Reset();
+	OutBlock.DenseItemIndices = MoveTemp(DenseItemIndices);
+	OutBlock.DenseItemIndices.Reset();
+	OutBlock.DensePageIndices = MoveTemp(DensePageIndices);
+	OutBlock.DensePageIndices.Reset();
+	PendingMIDs.Reset();
+	PendingItemFlags.Reset();
+	ThrottledMIDs.Reset();
+	ThrottledQueued.Reset();
+	ThrottledHead = 0;
+	FocusedMissions.Reset();
+
+	// Pages are subobjects of this tracker and go away with it, their item allocations are kept by page tag
+	for (int32 PageIndex = 0; PageIndex < Pages.Num(); PageIndex++)
+	{
+		if (Pages[PageIndex] == nullptr) { continue; }
+		TArray<FPDMissionNetDatum>& PageItems = OutBlock.PageItems.Add(Pages[PageIndex]->PageTag, MoveTemp(Pages[PageIndex]->State.Items));
+		PageItems.Reset();
+		Pages[PageIndex]->State.MarkArrayDirty();
+		MarkCompoundDirty(PageIndex);
+	}
+
+	State.MarkArrayDirty();
+	InvalidateHandleLookup();
+}
+
+void UPDMissionTracker::AcquireStateBlock(FPDMissionTrackerStateBlock&& Block)
+{
+	if (HasAnyItems()) { return; }
 	
-	const int32 ArrayIndex = mIDToReplIdMap.Contains(Data->Base.mID) ? *mIDToReplIdMap.Find(Data->Base.mID) - 1 : INDEX_NONE;
-	if (State.Items.IsValidIndex(ArrayIndex) == false) { return nullptr; }
+	State.Items = MoveTemp(Block.Items);
+	mIDToReplIdMap = MoveTemp(Block.mIDToReplIdMap);
+	DenseItemIndices = MoveTemp(Block.DenseItemIndices);
+	DensePageIndices = MoveTemp(Block.DensePageIndices);
 
-	return &State.Items[ArrayIndex];
+	// Pages are recreated for the tags the previous user had, the default template fills them right after
+	if (bPageByMissionType && GetOwnerRole() == ROLE_Authority)
+	{
+		for (TPair<FGameplayTag, TArray<FPDMissionNetDatum>>& PageItems : Block.PageItems)
+		{
+			const int32 PageIndex = FindOrAddPage(PageItems.Key);
+			Pages[PageIndex]->State.Items = MoveTemp(PageItems.Value);
+		}
+	}
+	InvalidateHandleLookup();
 }
 
 TEnumAsByte<EPDMissionState> UPDMissionTracker::GetStateSelector(const FGameplayTag& BaseTag) const
@@ -151,13 +1191,11 @@ TEnumAsByte<EPDMissionState> UPDMissionTracker::GetStateSelector(const FGameplay
 	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
 	if (MissionSubsystem == nullptr) { return EPDMissionState::EINVALID_STATE; }
 	
-	const FPDMissionRow* Data = MissionSubsystem->Utility.GetDefaultBaseViaTag(BaseTag);
-	if (Data == nullptr) { return EPDMissionState::EINVALID_STATE; }
+	const int32 mID = MissionSubsystem->Utility.ResolveMIDViaTag(BaseTag);
+	if (mID == INDEX_NONE) { return EPDMissionState::EINVALID_STATE; }
 	
-	const int32 ArrayIndex = mIDToReplIdMap.Contains(Data->Base.mID) ? *mIDToReplIdMap.Find(Data->Base.mID) - 1 : INDEX_NONE;
-	if (State.Items.IsValidIndex(ArrayIndex) == false) { return EPDMissionState::EINVALID_STATE; }
-
-	return State.Items[ArrayIndex].State.Current;
+	const FPDMissionNetDatum* Datum = FindDatum(mID);
+	return Datum != nullptr ? Datum->State.Current : EPDMissionState::EINVALID_STATE;
 }
 
 void UPDMissionTracker::OnDatumUpdated(const FPDMissionNetDatum* UpdatedMissionDatum) const
@@ -165,9 +1203,9 @@ void UPDMissionTracker::OnDatumUpdated(const FPDMissionNetDatum* UpdatedMissionD
 	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
 	if (UpdatedMissionDatum == nullptr || MissionSubsystem == nullptr) { return; }
 	
-	const FPDMissionRow* DefaultDatum = MissionSubsystem->Utility.GetDefaultBase(UpdatedMissionDatum->mID);
-	if (DefaultDatum == nullptr) { return; }
+	if (MissionSubsystem->Utility.IsValidMission(UpdatedMissionDatum->mID) == false) { return; }
 	
-	OnMissionUpdated.Broadcast(DefaultDatum->Base.mID, UpdatedMissionDatum->State.Current);
+	OnMissionUpdated.Broadcast(UpdatedMissionDatum->mID, UpdatedMissionDatum->State.Current);
+	PreloadUpcomingMissions(UpdatedMissionDatum->mID, UpdatedMissionDatum->State.Current);
 }
 
@@ -0,0 +1,237 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#include "Data/PDMissionCondition.h"
+#include "Interfaces/PDMissionInterface.h"
+
+FArchive& operator<<(FArchive& Ar, FPDMissionConditionInstr& Instr)
+{
+	Ar << Instr.Op << Instr.Compare << Instr.Operand << Instr.Value;
+	return Ar;
+}
+
+/** @brief Emits the node at 'Cursor' and its operands in postfix order. @return false if the expression ends early */
+static bool PDCompileConditionNode(const TArray<FPDMissionConditionNode>& Nodes, int32& Cursor, FPDMissionConditionProgram& OutProgram)
+{
+	if (Nodes.IsValidIndex(Cursor) == false) { return false; }
+
+	const FPDMissionConditionNode& Node = Nodes[Cursor++];
+	FPDMissionConditionInstr Instr;
+	Instr.Op = Node.Op;
+	switch (Node.Op)
+	{
+	case EConditionAnd:
+	case EConditionOr:
+		if (Node.NumChildren <= 0 || Node.NumChildren > MAX_uint16) { return false; }
+		for (int32 ChildIdx = 0; ChildIdx < Node.NumChildren; ChildIdx++)
+		{
+			if (PDCompileConditionNode(Nodes, Cursor, OutProgram) == false) { return false; }
+		}
+		Instr.Operand = static_cast<uint16>(Node.NumChildren);
+		break;
+	case EConditionNot:
+		if (PDCompileConditionNode(Nodes, Cursor, OutProgram) == false) { return false; }
+		break;
+	case EConditionHasTag:
+	case EConditionHasTagExact:
+	case EConditionCounter:
+		Instr.Operand = static_cast<uint16>(OutProgram.Tags.AddUnique(Node.Tag));
+		Instr.Compare = Node.Compare;
+		Instr.Value = Node.Value;
+		break;
+	default:
+		return false;
+	}
+	OutProgram.Code.Add(Instr);
+	return true;
+}
+
+bool FPDMissionConditionProgram::Compile(const TArray<FPDMissionConditionNode>& Nodes, FPDMissionConditionProgram& OutProgram)
+{
+	OutProgram.Code.Reset();
+	OutProgram.Tags.Reset();
+	if (Nodes.IsEmpty()) { return true; }
+
+	int32 Cursor = 0;
+	bool bSuccess = PDCompileConditionNode(Nodes, Cursor, OutProgram) && Cursor == Nodes.Num();
+
+	// Stack depth is checked here once, so evaluation can run on a fixed size stack without bounds checks
+	int32 Depth = 0;
+	for (int32 InstrIdx = 0; bSuccess && InstrIdx < OutProgram.Code.Num(); InstrIdx++)
+	{
+		const FPDMissionConditionInstr& Instr = OutProgram.Code[InstrIdx];
+		Depth += Instr.Op == EConditionAnd || Instr.Op == EConditionOr ? 1 - Instr.Operand : (Instr.Op == EConditionNot ? 0 : 1);
+		bSuccess = Depth > 0 && Depth <= MaxStackDepth;
+	}
+	
+	if (bSuccess == false)
+	{
+		OutProgram.Code.Reset();
+		OutProgram.Tags.Reset();
+	}
+	return bSuccess;
+}
+
+bool FPDMissionConditionProgram::Evaluate(const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags) const
+{
+	return Evaluate(Code, Tags, ActorTags, ExpandedTags);
+}
+
+bool FPDMissionConditionProgram::Evaluate(const TConstArrayView<FPDMissionConditionInstr> ProgramCode, const TConstArrayView<FGameplayTag> ProgramTags, const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags)
+{
+	if (ProgramCode.IsEmpty()) { return true; }
+
+	bool Stack[MaxStackDepth];
+	int32 Top = 0;
+	for (const FPDMissionConditionInstr& Instr : ProgramCode)
+	{
+		switch (Instr.Op)
+		{
+		case EConditionAnd:
+		case EConditionOr:
+			{
+				const int32 First = Top - Instr.Operand;
+				bool bResult = Instr.Op == EConditionAnd;
+				for (int32 StackIdx = First; StackIdx < Top; StackIdx++)
+				{
+					bResult = Instr.Op == EConditionAnd ? bResult && Stack[StackIdx] : bResult || Stack[StackIdx];
+				}
+				Top = First;
+				Stack[Top++] = bResult;
+			}
+			break;
+		case EConditionNot:
+			Stack[Top - 1] = Stack[Top - 1] == false;
+			break;
+		case EConditionHasTagExact:
+			Stack[Top++] = ActorTags.Contains(ProgramTags[Instr.Operand]);
+			break;
+		case EConditionHasTag:
+			Stack[Top++] = ExpandedTags.Contains(ProgramTags[Instr.Operand]);
+			break;
+		case EConditionCounter:
+			{
+				int32 Count = 0;
+				for (const FGameplayTag& ActorTag : ActorTags)
+				{
+					Count += ActorTag.MatchesTag(ProgramTags[Instr.Operand]) ? 1 : 0;
+				}
+
+				bool bResult = false;
+				switch (Instr.Compare)
+				{
+				case ECompareEqual:          bResult = Count == Instr.Value; break;
+				case ECompareNotEqual:       bResult = Count != Instr.Value; break;
+				case ECompareLess:           bResult = Count <  Instr.Value; break;
+				case ECompareLessOrEqual:    bResult = Count <= Instr.Value; break;
+				case ECompareGreater:        bResult = Count >  Instr.Value; break;
+				case ECompareGreaterOrEqual: bResult = Count >= Instr.Value; break;
+				default: ;
+				}
+				Stack[Top++] = bResult;
+			}
+			break;
+		default: ;
+		}
+	}
+	return Stack[0];
+}
+
+bool FPDMissionConditionProgram::Evaluate(const AActor* Caller) const
+{
+	if (Code.IsEmpty()) { return true; }
+	if (Caller == nullptr || Caller->IsValidLowLevelFast() == false || Caller->Implements<UPDMissionInterface>() == false)
+	{
+		return false;
+	}
+	const IPDMissionInterface* AsInterface = Cast<const IPDMissionInterface>(Caller);
+	return Evaluate(AsInterface->GetTagContainer(), AsInterface->GetExpandedTagContainer());
+}
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
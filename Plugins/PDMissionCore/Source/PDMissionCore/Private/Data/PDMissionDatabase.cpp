@@ -0,0 +1,420 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+
+#include "Data/PDMissionDatabase.h"
+
+#include <Engine/DataTable.h>
+#include <UObject/ObjectSaveContext.h>
+
+/** @brief Bump whenever the layout of any of the compiled structures changes, stale databases are discarded on load */
+static constexpr int32 GPDMissionDatabaseLayoutVersion = 4;
+
+//
+// Compiled types
+
+FArchive& operator<<(FArchive& Ar, FPDCompiledMissionCondition& Condition)
+{
+	Ar << Condition.FirstTag << Condition.NumRequiredTags << Condition.NumOptionalTags << Condition.NumExpressionTags << Condition.FirstInstr << Condition.NumInstrs;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FPDCompiledMissionBranch& Branch)
+{
+	// Every byte, padding included, bulk loading expects the per-element layout to match sizeof()
+	Ar << Branch.TargetMID << Branch.Condition << Branch.DelayTime << Branch.Type << Branch.bIsDirectBranch << Branch.Padding[0] << Branch.Padding[1];
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FPDCompiledMissionLookup& Lookup)
+{
+	Ar << Lookup.TagString << Lookup.TypeTagString << Lookup.RowNameString << Lookup.SourceTable;
+	return Ar;
+}
+
+//
+// Database
+
+void UPDMissionDatabase::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	int32 LayoutVersion = GPDMissionDatabaseLayoutVersion;
+	Ar << LayoutVersion;
+
+	if (Ar.IsLoading() && LayoutVersion != GPDMissionDatabaseLayoutVersion)
+	{
+		// Leave the arrays empty, the mission utility falls back to processing the tables when the database has no rows
+		UE_LOG(LogTemp, Error, TEXT("UPDMissionDatabase(%s) was compiled with layout version %i, expected %i. Discarding it, recompile the database"),
+			*GetName(), LayoutVersion, GPDMissionDatabaseLayoutVersion);
+		return;
+	}
+
+	HotStartStates.BulkSerialize(Ar);
+	HotFlags.BulkSerialize(Ar);
+	HotConditions.BulkSerialize(Ar);
+	HotFirstBranches.BulkSerialize(Ar);
+	HotNumBranches.BulkSerialize(Ar);
+	HotTickDeltaValues.BulkSerialize(Ar);
+	HotTickIntervals.BulkSerialize(Ar);
+	HotRepeatCooldowns.BulkSerialize(Ar);
+	Lookups.BulkSerialize(Ar);
+	Branches.BulkSerialize(Ar);
+	Conditions.BulkSerialize(Ar);
+	ConditionTags.BulkSerialize(Ar);
+	ConditionCode.BulkSerialize(Ar);
+	FirstPreloadAssets.BulkSerialize(Ar);
+	NumPreloadAssets.BulkSerialize(Ar);
+	StringData.BulkSerialize(Ar);
+	StringOffsets.BulkSerialize(Ar);
+}
+
+void UPDMissionDatabase::PostLoad()
+{
+	Super::PostLoad();
+	ResolveStringTable();
+}
+
+void UPDMissionDatabase::ResolveStringTable()
+{
+	ResolvedNames.Reset(StringOffsets.Num());
+	ResolvedTags.Reset(StringOffsets.Num());
+
+	for (const int32 Offset : StringOffsets)
+	{
+		const FName ResolvedName{UTF8_TO_TCHAR(reinterpret_cast<const ANSICHAR*>(StringData.GetData() + Offset))};
+		ResolvedNames.Add(ResolvedName);
+		ResolvedTags.Add(FGameplayTag::RequestGameplayTag(ResolvedName, false)); // Row names will resolve to an empty tag, that is expected
+	}
+
+	ResolvedConditionTags.Reset(ConditionTags.Num());
+	for (const int32 StringIndex : ConditionTags)
+	{
+		ResolvedConditionTags.Add(GetTag(StringIndex));
+	}
+}
+
+bool UPDMissionDatabase::EvaluateCondition(const int32 ConditionIndex, const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags) const
+{
+	const FPDCompiledMissionCondition* Condition = GetCondition(ConditionIndex);
+	if (Condition == nullptr) { return true; }
+
+	// Same semantics as FPDMissionTagCompound::CallerHasRequiredTags, every required tag and any of the optional tags
+	const int32 LastRequiredTag = Condition->FirstTag + Condition->NumRequiredTags;
+	for (int32 TagIndex = Condition->FirstTag; TagIndex < LastRequiredTag; TagIndex++)
+	{
+		if (ExpandedTags.Contains(ResolvedConditionTags[TagIndex]) == false) { return false; }
+	}
+
+	const int32 LastOptionalTag = LastRequiredTag + Condition->NumOptionalTags;
+	bool bHasOptionalTag = Condition->NumOptionalTags == 0;
+	for (int32 TagIndex = LastRequiredTag; bHasOptionalTag == false && TagIndex < LastOptionalTag; TagIndex++)
+	{
+		bHasOptionalTag = ExpandedTags.Contains(ResolvedConditionTags[TagIndex]);
+	}
+	if (bHasOptionalTag == false) { return false; }
+
+	// Runs straight off the flat arrays, the expression tag table follows the optional tags
+	const TConstArrayView<FPDMissionConditionInstr> Code = MakeArrayView(ConditionCode.GetData() + Condition->FirstInstr, Condition->NumInstrs);
+	const TConstArrayView<FGameplayTag> ExpressionTags = MakeArrayView(ResolvedConditionTags.GetData() + LastOptionalTag, Condition->NumExpressionTags);
+	return FPDMissionConditionProgram::Evaluate(Code, ExpressionTags, ActorTags, ExpandedTags);
+}
+
+FPDMissionTagSetHandle UPDMissionDatabase::InternConditionTags(const int32 ConditionIndex) const
+{
+	const FPDCompiledMissionCondition* Condition = GetCondition(ConditionIndex);
+	if (Condition == nullptr) { return FPDMissionTagSetHandle{}; }
+
+	const int32 LastRequiredTag = Condition->FirstTag + Condition->NumRequiredTags;
+	TArray<FGameplayTag> RequiredTags{ResolvedConditionTags.GetData() + Condition->FirstTag, Condition->NumRequiredTags};
+	TArray<FGameplayTag> OptionalTags{ResolvedConditionTags.GetData() + LastRequiredTag, Condition->NumOptionalTags};
+	return FPDMissionTagSetPool::Get().Intern(MoveTemp(RequiredTags), MoveTemp(OptionalTags));
+}
+
+UPDMissionMetadataStore* UPDMissionDatabase::LoadMetadataStore() const
+{
+	if (IsRunningDedicatedServer()) { return nullptr; }
+	return MetadataStore.LoadSynchronous();
+}
+
+#if WITH_EDITOR
+void UPDMissionDatabase::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	// The cook step, makes sure the cooked database always reflects the tables it is cooked alongside with
+	if (ObjectSaveContext.IsCooking())
+	{
+		CompileSourceTables();
+	}
+}
+
+void UPDMissionDatabase::CompileSourceTables()
+{
+	HotStartStates.Reset();
+	HotFlags.Reset();
+	HotConditions.Reset();
+	HotFirstBranches.Reset();
+	HotNumBranches.Reset();
+	HotTickDeltaValues.Reset();
+	HotTickIntervals.Reset();
+	HotRepeatCooldowns.Reset();
+	Lookups.Reset();
+	Branches.Reset();
+	Conditions.Reset();
+	ConditionTags.Reset();
+	ConditionCode.Reset();
+	FirstPreloadAssets.Reset();
+	NumPreloadAssets.Reset();
+	PreloadAssets.Reset();
+	StringData.Reset();
+	StringOffsets.Reset();
+
+	TMap<FString, int32> StringIndices;
+
+	// First pass assigns mIDs, same order as the table path in FPDMissionUtility::ProcessTablesForFastLookup, so branch targets can be resolved in the second pass 
+	int32 MissionID = 0x0;
+	TMap<TPair<const UDataTable*, FName>, int32> RowToMID;
+	TArray<UDataTable*> LoadedTables;
+	for (const TSoftObjectPtr<UDataTable>& SourceTable : SourceTables)
+	{
+		UDataTable* MissionTable = SourceTable.LoadSynchronous();
+		const bool bIsMissionTable = MissionTable != nullptr && MissionTable->GetRowStruct() == FPDMissionRow::StaticStruct();
+		LoadedTables.Add(bIsMissionTable ? MissionTable : nullptr);
+		if (bIsMissionTable == false) { continue; }
+
+		for (const TPair<FName, uint8*>& RowPair : MissionTable->GetRowMap())
+		{
+			RowToMID.Add({MissionTable, RowPair.Key}, ++MissionID);
+		}
+	}
+	HotStartStates.SetNumZeroed(MissionID);
+	HotFlags.SetNumZeroed(MissionID);
+	HotConditions.SetNumZeroed(MissionID);
+	HotFirstBranches.SetNumZeroed(MissionID);
+	HotNumBranches.SetNumZeroed(MissionID);
+	HotTickDeltaValues.SetNumZeroed(MissionID);
+	HotTickIntervals.SetNumZeroed(MissionID);
+	HotRepeatCooldowns.SetNumZeroed(MissionID);
+	FirstPreloadAssets.SetNumZeroed(MissionID);
+	NumPreloadAssets.SetNumZeroed(MissionID);
+	Lookups.SetNum(MissionID);
+
+	for (int32 TableIndex = 0; TableIndex < LoadedTables.Num(); TableIndex++)
+	{
+		const UDataTable* MissionTable = LoadedTables[TableIndex];
+		if (MissionTable == nullptr) { continue; }
+
+		for (const TPair<FName, uint8*>& RowPair : MissionTable->GetRowMap())
+		{
+			const FPDMissionRow* MissionRow = reinterpret_cast<const FPDMissionRow*>(RowPair.Value);
+			const int32 mID = RowToMID.FindChecked({MissionTable, RowPair.Key});
+			const FPDMissionRules& Rules = MissionRow->ProgressRules;
+
+			const int32 DenseIndex = mID - 1;
+
+			FPDCompiledMissionLookup& Lookup = Lookups[DenseIndex];
+			Lookup.TagString = AddString(MissionRow->Base.MissionBaseTag.ToString(), StringIndices);
+			Lookup.TypeTagString = AddString(MissionRow->Base.MissionBaseTag.RequestDirectParent().ToString(), StringIndices);
+			Lookup.RowNameString = AddString(RowPair.Key.ToString(), StringIndices);
+			Lookup.SourceTable = TableIndex;
+
+			HotStartStates[DenseIndex] = Rules.EStartState;
+			HotFlags[DenseIndex] = (Rules.bRepeatable ? ECompiledFlag_Repeatable : ECompiledFlag_None) | (MissionRow->TickSettings.bIsPaused ? ECompiledFlag_TickPaused : ECompiledFlag_None);
+			HotConditions[DenseIndex] = AddCondition(Rules.MissionConditionHandler, Rules.ConditionExpression, StringIndices);
+			HotTickDeltaValues[DenseIndex] = MissionRow->TickSettings.DeltaValue;
+			HotTickIntervals[DenseIndex] = MissionRow->TickSettings.Interval;
+			HotRepeatCooldowns[DenseIndex] = Rules.RepeatCooldown;
+
+			FirstPreloadAssets[DenseIndex] = PreloadAssets.Num();
+			NumPreloadAssets[DenseIndex] = MissionRow->PreloadAssets.Num();
+			PreloadAssets.Append(MissionRow->PreloadAssets);
+
+			HotFirstBranches[DenseIndex] = Branches.Num();
+			for (const FPDMissionBranchElement& BranchElement : Rules.NextMissionBranch.Branches)
+			{
+				const int32* TargetMID = RowToMID.Find({static_cast<const UDataTable*>(BranchElement.Target.DataTable), BranchElement.Target.RowName});
+				if (TargetMID == nullptr)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("UPDMissionDatabase::CompileSourceTables -- Row(%s) branches to row(%s) which is not in any of the source tables"),
+						*RowPair.Key.ToString(), *BranchElement.Target.RowName.ToString());
+				}
+				
+				FPDCompiledMissionBranch& CompiledBranch = Branches.AddDefaulted_GetRef();
+				CompiledBranch.TargetMID = TargetMID != nullptr ? *TargetMID : INDEX_NONE;
+				CompiledBranch.Condition = AddCondition(BranchElement.BranchConditions, BranchElement.BranchExpression, StringIndices);
+				CompiledBranch.DelayTime = BranchElement.TargetBehaviour.DelayTime;
+				CompiledBranch.Type = BranchElement.TargetBehaviour.Type;
+				CompiledBranch.bIsDirectBranch = BranchElement.bIsDirectBranch;
+			}
+			HotNumBranches[DenseIndex] = Branches.Num() - HotFirstBranches[DenseIndex];
+		}
+	}
+
+	ResolveStringTable();
+	MarkPackageDirty();
+}
+
+int32 UPDMissionDatabase::AddString(const FString& InString, TMap<FString, int32>& StringIndices)
+{
+	if (const int32* ExistingIndex = StringIndices.Find(InString)) { return *ExistingIndex; }
+
+	const FTCHARToUTF8 Converted(*InString);
+	const int32 StringIndex = StringOffsets.Add(StringData.Num());
+	StringData.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	StringData.Add(0); // Null-terminator
+	
+	StringIndices.Add(InString, StringIndex);
+	return StringIndex;
+}
+
+int32 UPDMissionDatabase::AddCondition(const FPDMissionTagCompound& Compound, const TArray<FPDMissionConditionNode>& Expression, TMap<FString, int32>& StringIndices)
+{
+	const TSet<FGameplayTag>& RequiredTags = Compound.GetRequiredMissionTags();
+	if (RequiredTags.IsEmpty() && Compound.OptionalUserTags.IsEmpty() && Expression.IsEmpty()) { return INDEX_NONE; }
+
+	// Compiled here rather than when loading, so the runtime evaluates the stored program as-is
+	FPDMissionConditionProgram Program;
+	if (FPDMissionConditionProgram::Compile(Expression, Program) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UPDMissionDatabase::AddCondition -- Malformed condition expression, it will be ignored"));
+	}
+
+	FPDCompiledMissionCondition& Condition = Conditions.AddDefaulted_GetRef();
+	Condition.FirstTag = ConditionTags.Num();
+	Condition.NumRequiredTags = RequiredTags.Num();
+	Condition.NumOptionalTags = Compound.OptionalUserTags.Num();
+	Condition.NumExpressionTags = Program.Tags.Num();
+	Condition.FirstInstr = ConditionCode.Num();
+	Condition.NumInstrs = Program.Code.Num();
+	
+	for (const FGameplayTag& Tag : RequiredTags) { ConditionTags.Add(AddString(Tag.ToString(), StringIndices)); }
+	for (const FGameplayTag& Tag : Compound.OptionalUserTags) { ConditionTags.Add(AddString(Tag.ToString(), StringIndices)); }
+	for (const FGameplayTag& Tag : Program.Tags) { ConditionTags.Add(AddString(Tag.ToString(), StringIndices)); }
+	ConditionCode.Append(Program.Code);
+	
+	return Conditions.Num() - 1;
+}
+
+//
+// Metadata store
+
+void UPDMissionMetadataStore::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	if (ObjectSaveContext.IsCooking())
+	{
+		CompileFromDatabase();
+	}
+}
+
+void UPDMissionMetadataStore::CompileFromDatabase()
+{
+	Metadata.Reset();
+
+	const UPDMissionDatabase* SourceDatabase = Database.LoadSynchronous();
+	if (SourceDatabase == nullptr) { return; }
+
+	// Same assignment order as UPDMissionDatabase::CompileSourceTables
+	for (const TSoftObjectPtr<UDataTable>& SourceTable : SourceDatabase->SourceTables)
+	{
+		const UDataTable* MissionTable = SourceTable.LoadSynchronous();
+		if (MissionTable == nullptr || MissionTable->GetRowStruct() != FPDMissionRow::StaticStruct()) { continue; }
+
+		for (const TPair<FName, uint8*>& RowPair : MissionTable->GetRowMap())
+		{
+			Metadata.Add(reinterpret_cast<const FPDMissionRow*>(RowPair.Value)->Metadata);
+		}
+	}
+	MarkPackageDirty();
+}
+#endif // WITH_EDITOR
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
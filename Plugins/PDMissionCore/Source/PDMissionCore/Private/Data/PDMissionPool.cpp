@@ -0,0 +1,257 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+
+#include "Data/PDMissionPool.h"
+
+//
+// Rotation definition
+
+int64 FPDMissionRotationDefinition::GetPeriodIndex(const FDateTime& UtcTime) const
+{
+	const int64 Days = UtcTime.GetTicks() / ETimespan::TicksPerDay;
+	return Period == EPDMissionRotationPeriod::ERotationWeekly ? Days / 7 : Days;
+}
+
+uint32 FPDMissionRotationDefinition::MakeRotationSeed(const int64 PeriodIndex, const int32 Salt) const
+{
+	// FName based hashes differ between processes, hash the tag string instead
+	uint32 RotationSeed = FCrc::StrCrc32(*RotationTag.ToString());
+	RotationSeed = HashCombine(RotationSeed, GetTypeHash(PeriodIndex));
+	RotationSeed = HashCombine(RotationSeed, GetTypeHash(Salt));
+	return HashCombine(RotationSeed, GetTypeHash(Seed));
+}
+
+//
+// Alias table
+
+void FPDMissionAliasTable::Build(const TConstArrayView<float> Weights)
+{
+	const int32 Num = Weights.Num();
+	Probabilities.SetNumUninitialized(Num);
+	Aliases.SetNumUninitialized(Num);
+
+	double Sum = 0.0;
+	for (const float Weight : Weights) { Sum += Weight; }
+	if (Num == 0 || Sum <= 0.0)
+	{
+		Probabilities.Reset();
+		Aliases.Reset();
+		return;
+	}
+
+	// Scaled so the average weight is 1, then each small column is topped up by a large one
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(Num);
+	TArray<int32> Small, Large;
+	Small.Reserve(Num);
+	Large.Reserve(Num);
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		Scaled[Idx] = Weights[Idx] * Num / Sum;
+		(Scaled[Idx] < 1.0 ? Small : Large).Add(Idx);
+	}
+
+	while (Small.IsEmpty() == false && Large.IsEmpty() == false)
+	{
+		const int32 SmallIdx = Small.Pop();
+		const int32 LargeIdx = Large.Pop();
+		Probabilities[SmallIdx] = static_cast<float>(Scaled[SmallIdx]);
+		Aliases[SmallIdx] = LargeIdx;
+
+		Scaled[LargeIdx] = (Scaled[LargeIdx] + Scaled[SmallIdx]) - 1.0;
+		(Scaled[LargeIdx] < 1.0 ? Small : Large).Add(LargeIdx);
+	}
+
+	// Whatever is left is only off from 1 by rounding errors
+	for (const int32 Idx : Large) { Probabilities[Idx] = 1.0f; Aliases[Idx] = Idx; }
+	for (const int32 Idx : Small) { Probabilities[Idx] = 1.0f; Aliases[Idx] = Idx; }
+}
+
+int32 FPDMissionAliasTable::Sample(const FRandomStream& Stream) const
+{
+	const int32 Column = Stream.RandHelper(Probabilities.Num());
+	return Stream.GetFraction() < Probabilities[Column] ? Column : Aliases[Column];
+}
+
+//
+// Mission pool
+
+void FPDMissionPool::Compile(const FPDMissionPoolDefinition& Definition, const TMap<FGameplayTag, int32>& MissionTagToMIDLookup)
+{
+	MemberMIDs.Reset();
+	MemberWeights.Reset();
+	MemberEntries.Reset();
+	EntryConditions.Reset();
+	TotalWeight = 0.0;
+
+	// Mission tag -> entry, first matching entry wins
+	TMap<FGameplayTag, int32> Members;
+	for (int32 EntryIdx = 0; EntryIdx < Definition.Entries.Num(); EntryIdx++)
+	{
+		const FPDMissionPoolEntry& Entry = Definition.Entries[EntryIdx];
+		
+		FPDMissionConditionProgram& Condition = EntryConditions.AddDefaulted_GetRef();
+		if (FPDMissionConditionProgram::Compile(Entry.Condition, Condition) == false)
+		{
+			UE_LOG(LogTemp, Error, TEXT("FPDMissionPool::Compile -- Malformed condition on entry(%i) of pool(%s), it will be ignored"), EntryIdx, *Definition.PoolTag.ToString());
+		}
+		if (Entry.Weight <= 0.0f || Entry.MissionFilterTag.IsValid() == false) { continue; }
+
+		for (const TPair<FGameplayTag, int32>& MissionPair : MissionTagToMIDLookup)
+		{
+			if (MissionPair.Key.MatchesTag(Entry.MissionFilterTag) && Members.Contains(MissionPair.Key) == false)
+			{
+				Members.Add(MissionPair.Key, EntryIdx);
+			}
+		}
+	}
+
+	// Neither map order nor mIDs are stable between processes, mIDs depend on table load order. Order by tag name so seeded draws match on server and clients
+	Members.KeySort([](const FGameplayTag& A, const FGameplayTag& B) { return A.GetTagName().Compare(B.GetTagName()) < 0; });
+	for (const TPair<FGameplayTag, int32>& Member : Members)
+	{
+		const float Weight = Definition.Entries[Member.Value].Weight;
+		MemberMIDs.Add(MissionTagToMIDLookup.FindChecked(Member.Key));
+		MemberWeights.Add(Weight);
+		MemberEntries.Add(Member.Value);
+		TotalWeight += Weight;
+	}
+
+	AliasTable.Build(MemberWeights);
+}
+
+int32 FPDMissionPool::Draw(const int32 Count, TBitArray<>& Remaining, double RemainingWeight, const FRandomStream& Stream, TArray<int32>& OutMIDs) const
+{
+	const FPDMissionAliasTable* Table = &AliasTable;
+	double TableWeight = TotalWeight;
+	
+	FPDMissionAliasTable LocalTable;
+	TArray<int32> LocalMembers; // Local column -> member index, only used once re-tabulated
+	TArray<float> LocalWeights;
+	
+	int32 NumDrawn = 0;
+	while (NumDrawn < Count && RemainingWeight > UE_SMALL_NUMBER && Table->IsEmpty() == false)
+	{
+		// Rejections get expensive once most of the tables weight is ineligible, re-tabulate over what is left
+		if (RemainingWeight < TableWeight * 0.5)
+		{
+			LocalMembers.Reset();
+			LocalWeights.Reset();
+			for (TConstSetBitIterator<> BitIt(Remaining); BitIt; ++BitIt)
+			{
+				LocalMembers.Add(BitIt.GetIndex());
+				LocalWeights.Add(MemberWeights[BitIt.GetIndex()]);
+			}
+			if (LocalMembers.IsEmpty()) { break; }
+			
+			LocalTable.Build(LocalWeights);
+			Table = &LocalTable;
+			TableWeight = RemainingWeight;
+		}
+
+		const int32 Column = Table->Sample(Stream);
+		const int32 MemberIdx = Table == &LocalTable ? LocalMembers[Column] : Column;
+		if (Remaining[MemberIdx] == false) { continue; } // Rejected, ineligible or already drawn
+
+		Remaining[MemberIdx] = false;
+		RemainingWeight -= MemberWeights[MemberIdx];
+		OutMIDs.Add(MemberMIDs[MemberIdx]);
+		NumDrawn++;
+	}
+	return NumDrawn;
+}
+
+void FPDMissionPool::DrawRotation(const int32 Count, const uint32 Seed, TArray<int32>& OutMIDs) const
+{
+	TBitArray<> Remaining(true, Num());
+	Draw(Count, Remaining, TotalWeight, FRandomStream{static_cast<int32>(Seed)}, OutMIDs);
+}
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
@@ -0,0 +1,296 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+
+#include "Data/PDMissionTagSet.h"
+#include "PDMissionCommon.h"
+#include "Interfaces/PDMissionInterface.h"
+
+#include <Algo/Sort.h>
+
+//
+// Tag set
+
+bool FPDMissionTagSet::IsSatisfiedBy(const TSet<FGameplayTag>& ActorTags) const
+{
+	for (const FGameplayTag& Tag : RequiredTags)
+	{
+		if (ActorTags.Contains(Tag) == false) { return false; }
+	}
+
+	if (OptionalTags.IsEmpty()) { return true; }
+	for (const FGameplayTag& Tag : OptionalTags)
+	{
+		if (ActorTags.Contains(Tag)) { return true; }
+	}
+	return false;
+}
+
+bool FPDMissionTagSet::CallerHasRequiredTags(const AActor* Caller) const
+{
+	if (Caller == nullptr || Caller->IsValidLowLevelFast() == false || Caller->Implements<UPDMissionInterface>() == false)
+	{
+		return false;
+	}
+	return IsSatisfiedBy(Cast<const IPDMissionInterface>(Caller)->GetExpandedTagContainer());
+}
+
+//
+// Tag set handle
+
+const FPDMissionTagSet& FPDMissionTagSetHandle::Get() const
+{
+	return FPDMissionTagSetPool::Get().Resolve(*this);
+}
+
+bool FPDMissionTagSetHandle::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+	const FPDMissionTagSetPool& Pool = FPDMissionTagSetPool::Get();
+
+	// Mission condition sets go out as their shared index, the tags only go out for sets no mission row uses. Packed as 'SharedIndex + 1', 0 is the empty set
+	uint32 PackedIndex = 0;
+	uint8 bIsShared = 1;
+	if (Ar.IsSaving() && IsEmpty() == false)
+	{
+		const int32 SharedIndex = Pool.FindSharedIndex(*this);
+		bIsShared = SharedIndex != INDEX_NONE;
+		PackedIndex = bIsShared ? static_cast<uint32>(SharedIndex) + 1 : 0;
+	}
+	Ar.SerializeBits(&bIsShared, 1);
+
+	if (bIsShared)
+	{
+		Ar.SerializeIntPacked(PackedIndex);
+		if (Ar.IsLoading()) { *this = PackedIndex == 0 ? FPDMissionTagSetHandle{} : Pool.ResolveSharedIndex(static_cast<int32>(PackedIndex) - 1); }
+		return true;
+	}
+
+	if (Ar.IsSaving())
+	{
+		const FPDMissionTagSet& TagSet = Get();
+		for (const TArray<FGameplayTag>* Tags : {&TagSet.RequiredTags, &TagSet.OptionalTags})
+		{
+			uint32 NumTags = Tags->Num();
+			Ar.SerializeIntPacked(NumTags);
+			for (const FGameplayTag& Tag : *Tags)
+			{
+				bool bTagSuccess = true;
+				const_cast<FGameplayTag&>(Tag).NetSerialize(Ar, Map, bTagSuccess);
+				bOutSuccess &= bTagSuccess;
+			}
+		}
+		return true;
+	}
+
+	TArray<FGameplayTag> RequiredTags;
+	TArray<FGameplayTag> OptionalTags;
+	for (TArray<FGameplayTag>* Tags : {&RequiredTags, &OptionalTags})
+	{
+		uint32 NumTags = 0;
+		Ar.SerializeIntPacked(NumTags);
+		if (Ar.IsError()) { bOutSuccess = false; return false; }
+		
+		Tags->SetNum(NumTags);
+		for (FGameplayTag& Tag : *Tags)
+		{
+			bool bTagSuccess = true;
+			Tag.NetSerialize(Ar, Map, bTagSuccess);
+			bOutSuccess &= bTagSuccess;
+		}
+	}
+
+	*this = FPDMissionTagSetPool::Get().Intern(MoveTemp(RequiredTags), MoveTemp(OptionalTags));
+	return true;
+}
+
+//
+// Tag set pool
+
+FPDMissionTagSetPool& FPDMissionTagSetPool::Get()
+{
+	static FPDMissionTagSetPool Pool;
+	return Pool;
+}
+
+FPDMissionTagSetPool::FPDMissionTagSetPool()
+{
+	// Index 0 is reserved for the empty set, so default constructed handles are always valid
+	Chunks[0] = MakeUnique<FPDMissionTagSet[]>(ChunkSize);
+	NumEntries.store(1, std::memory_order_release);
+}
+
+FPDMissionTagSetHandle FPDMissionTagSetPool::Intern(const FPDMissionTagCompound& Compound)
+{
+	return Intern(Compound.GetRequiredMissionTags().Array(), Compound.OptionalUserTags.Array());
+}
+
+FPDMissionTagSetHandle FPDMissionTagSetPool::Intern(TArray<FGameplayTag>&& RequiredTags, TArray<FGameplayTag>&& OptionalTags)
+{
+	if (RequiredTags.IsEmpty() && OptionalTags.IsEmpty()) { return FPDMissionTagSetHandle{}; }
+
+	// Canonical order so that equal sets hash and compare equal regardless of insertion order
+	const auto TagLess = [](const FGameplayTag& A, const FGameplayTag& B) { return A.GetTagName().FastLess(B.GetTagName()); };
+	Algo::Sort(RequiredTags, TagLess);
+	Algo::Sort(OptionalTags, TagLess);
+
+	uint32 Hash = GetTypeHash(RequiredTags.Num());
+	for (const FGameplayTag& Tag : RequiredTags) { Hash = HashCombine(Hash, GetTypeHash(Tag)); }
+	for (const FGameplayTag& Tag : OptionalTags) { Hash = HashCombine(Hash, GetTypeHash(Tag)); }
+
+	FRWScopeLock ScopeLock(PoolLock, SLT_Write);
+
+	TArray<int32, TInlineAllocator<4>> Candidates;
+	HashToIndex.MultiFind(Hash, Candidates);
+	for (const int32 Candidate : Candidates)
+	{
+		const FPDMissionTagSet& Existing = GetEntry(Candidate);
+		if (Existing.RequiredTags == RequiredTags && Existing.OptionalTags == OptionalTags) { return FPDMissionTagSetHandle{Candidate}; }
+	}
+
+	const int32 NewIndex = NumEntries.load(std::memory_order_relaxed);
+	if (NewIndex >= ChunkSize * MaxChunks)
+	{
+		UE_LOG(LogTemp, Error, TEXT("FPDMissionTagSetPool::Intern -- Pool is full (%i sets), resolving to the empty set"), NewIndex);
+		return FPDMissionTagSetHandle{};
+	}
+
+	if (Chunks[NewIndex / ChunkSize].IsValid() == false)
+	{
+		Chunks[NewIndex / ChunkSize] = MakeUnique<FPDMissionTagSet[]>(ChunkSize);
+	}
+
+	FPDMissionTagSet& NewEntry = Chunks[NewIndex / ChunkSize][NewIndex % ChunkSize];
+	NewEntry.RequiredTags = MoveTemp(RequiredTags);
+	NewEntry.OptionalTags = MoveTemp(OptionalTags);
+	NewEntry.Hash = Hash;
+	HashToIndex.Add(Hash, NewIndex);
+
+	// Only now visible to readers
+	NumEntries.store(NewIndex + 1, std::memory_order_release);
+	return FPDMissionTagSetHandle{NewIndex};
+}
+
+const FPDMissionTagSet& FPDMissionTagSetPool::Resolve(const FPDMissionTagSetHandle& Handle) const
+{
+	const bool bIsValidIndex = Handle.Index > 0 && Handle.Index < NumEntries.load(std::memory_order_acquire);
+	return GetEntry(bIsValidIndex ? Handle.Index : 0);
+}
+
+int32 FPDMissionTagSetPool::Num() const
+{
+	return NumEntries.load(std::memory_order_acquire);
+}
+
+void FPDMissionTagSetPool::SetSharedSets(const TArray<FPDMissionTagSetHandle>& InSharedSets)
+{
+	check(IsInGameThread());
+	
+	SharedSets = InSharedSets;
+	HandleToSharedIndex.Reset();
+	for (int32 SharedIndex = 0; SharedIndex < SharedSets.Num(); SharedIndex++)
+	{
+		// Ascending, so the lowest index wins on both ends
+		if (SharedSets[SharedIndex].IsEmpty() || HandleToSharedIndex.Contains(SharedSets[SharedIndex].Index)) { continue; }
+		HandleToSharedIndex.Add(SharedSets[SharedIndex].Index, SharedIndex);
+	}
+}
+
+int32 FPDMissionTagSetPool::FindSharedIndex(const FPDMissionTagSetHandle& Handle) const
+{
+	const int32* SharedIndex = HandleToSharedIndex.Find(Handle.Index);
+	return SharedIndex != nullptr ? *SharedIndex : INDEX_NONE;
+}
+
+FPDMissionTagSetHandle FPDMissionTagSetPool::ResolveSharedIndex(const int32 SharedIndex) const
+{
+	return SharedSets.IsValidIndex(SharedIndex) ? SharedSets[SharedIndex] : FPDMissionTagSetHandle{};
+}
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
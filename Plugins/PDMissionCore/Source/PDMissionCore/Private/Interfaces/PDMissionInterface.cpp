@@ -1,8 +1,12 @@
 /* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
 
 #include "Interfaces/PDMissionInterface.h"												 
+#include "Actors/PDMissionGroup.h"
 #include "Components/PDMissionTracker.h"
 #include "Subsystems/PDMissionSubsystem.h"
+#include "Data/PDMissionStateMachine.h"
+
+#include "GameplayTagsManager.h"
 
 #ifdef MGETTRACKER_EXITNONAUTH
 #undef MGETTRACKER_EXITNONAUTH
@@ -51,11 +55,45 @@ void IPDMissionInterface::RemoveMissionFromActor_Implementation(AActor* CallingA
 void IPDMissionInterface::AddTagsToContainer_Implementation(TArray<FGameplayTag>& Tags)
 {
 	FPDPrivateMissionHandler::_AddTagsToContainer(Tags, TagContainer);
+	MarkTagContainerChanged();
 }
 
 void IPDMissionInterface::RemoveTagsToContainer_Implementation(TArray<FGameplayTag>& DeleteTags)
 {
 	FPDPrivateMissionHandler::_RemoveTagsToContainer(DeleteTags, TagContainer);
+	MarkTagContainerChanged();
+}
+
+void IPDMissionInterface::MarkTagContainerChanged()
+{
+	++TagContainerVersion;
+
+	// Shared missions are checked against the aggregated tags of the group, which include the tags of every member
+	const AActor* AsActor = Cast<AActor>(_getUObject());
+	const UPDMissionTracker* MissionTracker = AsActor != nullptr ? AsActor->FindComponentByClass<UPDMissionTracker>() : nullptr;
+	if (MissionTracker == nullptr || MissionTracker->GroupTracker == nullptr) { return; }
+
+	APDMissionGroup* Group = Cast<APDMissionGroup>(MissionTracker->GroupTracker->GetOwner());
+	if (Group != nullptr && Group != AsActor) { Group->RefreshGroupTags(); }
+}
+
+const TSet<FGameplayTag>& IPDMissionInterface::GetExpandedTagContainer() const
+{
+	if (ExpandedTagVersion == TagContainerVersion) { return ExpandedTagContainer; }
+
+	ExpandedTagContainer.Reset();
+	const UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+	TArray<FGameplayTag> Parents;
+	for (const FGameplayTag& Tag : TagContainer)
+	{
+		ExpandedTagContainer.Add(Tag);
+		
+		Parents.Reset();
+		TagsManager.ExtractParentTags(Tag, Parents);
+		ExpandedTagContainer.Append(Parents);
+	}
+	ExpandedTagVersion = TagContainerVersion;
+	return ExpandedTagContainer;
 }
 
 void FPDPrivateMissionHandler::_GrantMissionToActor(const AActor* CallingActor, FName MissionName)  
@@ -73,20 +111,14 @@ void FPDPrivateMissionHandler::_GrantMissionToActor(const AActor* CallingActor,
 	// Grant the skills, if they are not already granted
 	const FGameplayTag MissionTag = FGameplayTag::RequestGameplayTag(MissionName, false);
 
+	// mIDs are resolved through the lookups rather than read from the row, cooked rows are never rewritten
+	int32 mID = INDEX_NONE; 
+	if (MissionTag != FGameplayTag()) { mID = MissionSubsystem->Utility.ResolveMIDViaTag(MissionTag); }
+
 	//
 	// @note Find skill by row-name if called from console, allows to skipping to having to input the full tag hierarchy. @note conflicting names are not handled
-	const FPDMissionRow* FoundMissionData = nullptr; 
-	if (MissionSubsystem->Utility.MissionLookupViaRowName.Contains(MissionName))
-	{
-		const FDataTableRowHandle* FoundHandle = MissionSubsystem->Utility.MissionLookupViaRowName.Find(MissionName);
-		FoundMissionData = FoundHandle->GetRow<FPDMissionRow>("");
-	}
-
-	int32 mID = INDEX_NONE; 
-	if (MissionTag != FGameplayTag())     { mID = MissionSubsystem->Utility.ResolveMIDViaTag(MissionTag); }
-	else if (FoundMissionData != nullptr) { mID = FoundMissionData->Base.mID; }
+	if (mID == INDEX_NONE) { mID = MissionSubsystem->Utility.ResolveMIDViaRowName(MissionName); }
 	
-	mID = mID == INDEX_NONE && FoundMissionData != nullptr ? FoundMissionData->Base.mID : INDEX_NONE;
 	if (mID == INDEX_NONE) // Are we still INDEX_NONE? Invalid skill 
 	{
 		UE_LOG(LogTemp, Warning, TEXT("%s,  Found no mission by the name of '%s'"), *BuildString, *MissionName.ToString());
@@ -102,16 +134,13 @@ void FPDPrivateMissionHandler::_GrantMissionToActor(const AActor* CallingActor,
 		return;
 	}
 
-	FPDMissionNetDatum OverwriteDatum = *ExistingDatum;
-	if (OverwriteDatum.State.Current == EPDMissionState::EInactive)
+	if (MissionTracker->TransitionMission(MissionSubsystem->Utility.GetMissionBaseTag(mID), EEventActivate))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("%s, Enabling mission by the ID of '%i' and by name of '%s'"), *BuildString , mID, *MissionName.ToString());
-		OverwriteDatum.State.Current = EPDMissionState::EActive;
-		MissionSubsystem->Utility.OverwriteMissionDatum(MissionTracker, mID, OverwriteDatum);
 		return;
 	}
 	
-	UE_LOG(LogTemp, Warning, TEXT("%s, Mission(%s) was already enabled.'"), *BuildString, *MissionName.ToString());
+	UE_LOG(LogTemp, Warning, TEXT("%s, Mission(%s) was already enabled or is still locked.'"), *BuildString, *MissionName.ToString());
 }
 
 void FPDPrivateMissionHandler::_RemoveMissionFromActor(const AActor* CallingActor, FName MissionName)
@@ -128,15 +157,8 @@ void FPDPrivateMissionHandler::_RemoveMissionFromActor(const AActor* CallingActo
 	// Grant the skills, @todo  if they are not already granted
 	const FGameplayTag MissionTag = FGameplayTag::RequestGameplayTag(MissionName, false);
 
-	const FPDMissionRow* FoundMissionDefaultData = nullptr; 
-	if (MissionSubsystem->Utility.MissionLookupViaRowName.Contains(MissionName))
-	{
-		const FDataTableRowHandle* FoundHandle = MissionSubsystem->Utility.MissionLookupViaRowName.Find(MissionName);
-		FoundMissionDefaultData = FoundHandle->GetRow<FPDMissionRow>("");
-	}
-
 	const int32 PotentialSID = MissionSubsystem->Utility.ResolveMIDViaTag(MissionTag);
-	const int32 mID = MissionTag != FGameplayTag() && PotentialSID != INDEX_NONE ? PotentialSID : FoundMissionDefaultData != nullptr ? FoundMissionDefaultData->Base.mID : INDEX_NONE; 
+	const int32 mID = MissionTag != FGameplayTag() && PotentialSID != INDEX_NONE ? PotentialSID : MissionSubsystem->Utility.ResolveMIDViaRowName(MissionName); 
 	if (mID  == INDEX_NONE)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("%s -- Found no mission by the name of '%s'"), *BaseString, *MissionName.ToString());
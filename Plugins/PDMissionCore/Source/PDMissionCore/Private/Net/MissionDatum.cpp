@@ -3,15 +3,20 @@
 
 #include "Net/MissionDatum.h"
 #include "Components/PDMissionTracker.h"
+#include "Subsystems/PDMissionSubsystem.h"
+
+#include <Engine/PackageMapClient.h>
 
 void FPDMissionNetDatum::PreReplicatedRemove(const FPDMissionNetDataCompound& InArraySerializer)
 {
 	check(InArraySerializer.OwnerTracker != nullptr);
+	InArraySerializer.OwnerTracker->InvalidateHandleLookup();
 }
 
 void FPDMissionNetDatum::PostReplicatedAdd(const FPDMissionNetDataCompound& InArraySerializer)
 {
 	check(InArraySerializer.OwnerTracker != nullptr);
+	InArraySerializer.OwnerTracker->InvalidateHandleLookup();
 	InArraySerializer.OwnerTracker->OnDatumUpdated(this);
 }
 
@@ -23,5 +28,231 @@ void FPDMissionNetDatum::PostReplicatedChange(const FPDMissionNetDataCompound& I
 
 bool FPDMissionNetDataCompound::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams)
 {
+	// Every write is prefixed with a bit telling the reader if a snapshot or a regular delta follows
+	if (DeltaParams.Writer != nullptr)
+	{
+		// Default runs are rebuilt from the readers own missions, so snapshots only go to connections that confirmed they match ours
+		const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+		UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParams.Map);
+		const UNetConnection* Connection = PackageMap != nullptr ? PackageMap->GetConnection() : nullptr;
+		const bool bSendSnapshot = DeltaParams.OldState == nullptr && Items.IsEmpty() == false
+			&& MissionSubsystem != nullptr && MissionSubsystem->Utility.IsConnectionInSync(Connection);
+		DeltaParams.Writer->WriteBit(bSendSnapshot ? 1 : 0);
+		if (bSendSnapshot) { return WriteInitialSnapshot(DeltaParams); }
+	}
+	else if (DeltaParams.Reader != nullptr)
+	{
+		if (DeltaParams.Reader->ReadBit() != 0) { return ReadInitialSnapshot(DeltaParams); }
+	}
+	
 	return FFastArraySerializer::FastArrayDeltaSerialize<FPDMissionNetDatum, FPDMissionNetDataCompound>(Items, DeltaParams, *this);
 }
+
+/** @brief Payload bits of a non-default item in a snapshot */
+enum EPDSnapshotItemFlags : uint8
+{
+	ESnapshotItem_None         = 0,
+	ESnapshotItem_TickSettings = 1 << 0,
+	ESnapshotItem_Deadline     = 1 << 1,
+};
+
+bool FPDMissionNetDataCompound::WriteInitialSnapshot(FNetDeltaSerializeInfo& DeltaParams)
+{
+	FBitWriter& Writer = *DeltaParams.Writer;
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+
+	// Same as the regular fast array path, items that have never been marked get their IDs now
+	for (FPDMissionNetDatum& Item : Items)
+	{
+		if (Item.ReplicationID == INDEX_NONE) { MarkItemDirty(Item); }
+	}
+
+	uint32 NumItems = Items.Num();
+	int32 ArrayKey = ArrayReplicationKey;
+	uint32 Checksum = MissionSubsystem != nullptr ? MissionSubsystem->Utility.GetDatabaseChecksum() : 0;
+	Writer.SerializeIntPacked(NumItems);
+	Writer << ArrayKey;
+	Writer << Checksum;
+
+	// Identity runs, trackers initialized from the default template hold consecutive mIDs with consecutive replication IDs, so this is usually a single run
+	for (int32 RunStart = 0; RunStart < Items.Num();)
+	{
+		int32 RunEnd = RunStart + 1;
+		while (RunEnd < Items.Num() && Items[RunEnd].mID == Items[RunEnd - 1].mID + 1 && Items[RunEnd].ReplicationID == Items[RunEnd - 1].ReplicationID + 1) { RunEnd++; }
+
+		uint32 RunLength = RunEnd - RunStart;
+		uint32 FirstMID = Items[RunStart].mID;
+		uint32 FirstReplicationID = Items[RunStart].ReplicationID;
+		Writer.SerializeIntPacked(RunLength);
+		Writer.SerializeIntPacked(FirstMID);
+		Writer.SerializeIntPacked(FirstReplicationID);
+		RunStart = RunEnd;
+	}
+
+	// Default runs, items that still hold their missions default state are implied by the run and carry no payload
+	static const FPDMissionTickBehaviour DefaultTickSettings{};
+	for (int32 RunStart = 0; RunStart < Items.Num();)
+	{
+		const bool bDefaultRun = MissionSubsystem != nullptr && MissionSubsystem->Utility.IsDefaultDatum(Items[RunStart]);
+		int32 RunEnd = RunStart + 1;
+		while (RunEnd < Items.Num() && (MissionSubsystem != nullptr && MissionSubsystem->Utility.IsDefaultDatum(Items[RunEnd])) == bDefaultRun) { RunEnd++; }
+
+		uint32 RunLength = RunEnd - RunStart;
+		Writer.SerializeIntPacked(RunLength);
+		Writer.WriteBit(bDefaultRun ? 1 : 0);
+
+		for (int32 ItemIndex = RunStart; bDefaultRun == false && ItemIndex < RunEnd; ItemIndex++)
+		{
+			FPDMissionNetDatum& Item = Items[ItemIndex];
+			uint8 StateByte = Item.State.Current;
+			Writer << StateByte;
+			
+			bool bHandleSuccess = true;
+			Item.State.MissionConditionHandle.NetSerialize(Writer, DeltaParams.Map, bHandleSuccess);
+
+			const bool bHasTickSettings = Item.TickSettings.DeltaValue != DefaultTickSettings.DeltaValue
+				|| Item.TickSettings.Interval != DefaultTickSettings.Interval
+				|| Item.TickSettings.bIsPaused != DefaultTickSettings.bIsPaused;
+			uint8 ItemFlags = bHasTickSettings ? ESnapshotItem_TickSettings : ESnapshotItem_None;
+			ItemFlags |= Item.HasDeadline() ? ESnapshotItem_Deadline : ESnapshotItem_None;
+			Writer << ItemFlags;
+			if (bHasTickSettings)
+			{
+				Writer << Item.TickSettings.DeltaValue << Item.TickSettings.Interval;
+				Writer.WriteBit(Item.TickSettings.bIsPaused ? 1 : 0);
+			}
+			if (Item.HasDeadline())
+			{
+				Writer.SerializeIntPacked(Item.DeadlineTenths);
+			}
+		}
+		RunStart = RunEnd;
+	}
+
+	// Base state for this connection, the next call only sends items that changed after the snapshot
+	FNetFastTArrayBaseState* NewState = new FNetFastTArrayBaseState();
+	NewState->ArrayReplicationKey = ArrayReplicationKey;
+	NewState->IDToCLMap.Reserve(Items.Num());
+	for (const FPDMissionNetDatum& Item : Items)
+	{
+		NewState->IDToCLMap.Add(Item.ReplicationID, Item.ReplicationKey);
+	}
+	check(DeltaParams.NewState != nullptr);
+	*DeltaParams.NewState = MakeShareable(NewState);
+	return true;
+}
+
+bool FPDMissionNetDataCompound::ReadInitialSnapshot(FNetDeltaSerializeInfo& DeltaParams)
+{
+	FBitReader& Reader = *DeltaParams.Reader;
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+
+	uint32 NumItems = 0;
+	int32 ArrayKey = 0;
+	uint32 Checksum = 0;
+	Reader.SerializeIntPacked(NumItems);
+	Reader << ArrayKey;
+	Reader << Checksum;
+	if (Reader.IsError()) { return false; }
+
+	// Default items are rebuilt from local data, which is only valid if the client maps the same missions as the server.
+	// A mismatching snapshot is still read to the end, to keep the stream aligned, but nothing from it is kept 
+	const uint32 NumLocalMissions = MissionSubsystem != nullptr ? MissionSubsystem->Utility.GetNumDenseMissions() : 0;
+	bool bIsCompatible = MissionSubsystem != nullptr && Checksum == MissionSubsystem->Utility.GetDatabaseChecksum() && NumItems <= NumLocalMissions;
+	
+	TArray<FPDMissionNetDatum> ReadItems;
+	ReadItems.SetNum(bIsCompatible ? NumItems : 0);
+
+	for (uint32 ItemIndex = 0; ItemIndex < NumItems && Reader.IsError() == false;)
+	{
+		uint32 RunLength = 0, FirstMID = 0, FirstReplicationID = 0;
+		Reader.SerializeIntPacked(RunLength);
+		Reader.SerializeIntPacked(FirstMID);
+		Reader.SerializeIntPacked(FirstReplicationID);
+		if (RunLength == 0) { Reader.SetError(); break; }
+
+		RunLength = FMath::Min(RunLength, NumItems - ItemIndex);
+		bIsCompatible &= FirstMID >= 1 && static_cast<uint64>(FirstMID) + RunLength - 1 <= NumLocalMissions;
+		for (uint32 RunIndex = 0; bIsCompatible && RunIndex < RunLength; RunIndex++)
+		{
+			ReadItems[ItemIndex + RunIndex].mID = FirstMID + RunIndex;
+			ReadItems[ItemIndex + RunIndex].ReplicationID = FirstReplicationID + RunIndex;
+		}
+		ItemIndex += RunLength;
+	}
+
+	FPDMissionNetDatum DiscardedItem;
+	for (uint32 ItemIndex = 0; ItemIndex < NumItems && Reader.IsError() == false;)
+	{
+		uint32 RunLength = 0;
+		Reader.SerializeIntPacked(RunLength);
+		const bool bDefaultRun = Reader.ReadBit() != 0;
+		if (RunLength == 0) { Reader.SetError(); break; }
+		
+		RunLength = FMath::Min(RunLength, NumItems - ItemIndex);
+		for (uint32 RunIndex = 0; bDefaultRun && bIsCompatible && RunIndex < RunLength; RunIndex++)
+		{
+			FPDMissionNetDatum& Item = ReadItems[ItemIndex + RunIndex];
+			const int32 ReplicationID = Item.ReplicationID;
+			Item = MissionSubsystem->Utility.MakeDefaultDatum(Item.mID);
+			Item.ReplicationID = ReplicationID;
+		}
+		
+		for (uint32 RunIndex = 0; bDefaultRun == false && RunIndex < RunLength && Reader.IsError() == false; RunIndex++)
+		{
+			FPDMissionNetDatum& Item = bIsCompatible ? ReadItems[ItemIndex + RunIndex] : DiscardedItem;
+			uint8 StateByte = 0;
+			Reader << StateByte;
+			Item.State.Current = static_cast<EPDMissionState>(StateByte);
+
+			bool bHandleSuccess = true;
+			Item.State.MissionConditionHandle.NetSerialize(Reader, DeltaParams.Map, bHandleSuccess);
+
+			uint8 ItemFlags = ESnapshotItem_None;
+			Reader << ItemFlags;
+			if ((ItemFlags & ESnapshotItem_TickSettings) != 0)
+			{
+				Reader << Item.TickSettings.DeltaValue << Item.TickSettings.Interval;
+				Item.TickSettings.bIsPaused = Reader.ReadBit() != 0;
+			}
+			if ((ItemFlags & ESnapshotItem_Deadline) != 0)
+			{
+				Reader.SerializeIntPacked(Item.DeadlineTenths);
+			}
+		}
+		ItemIndex += RunLength;
+	}
+
+	// Anything the client held before is replaced by the snapshot, or dropped if the snapshot can not be used
+	for (FPDMissionNetDatum& Item : Items)
+	{
+		Item.PreReplicatedRemove(*this);
+	}
+	Items.Reset();
+	ItemMap.Reset();
+	
+	if (Reader.IsError()) { return false; }
+
+	if (bIsCompatible == false)
+	{
+		// Our missions changed after the connection reported its checksum. The server still holds a base state for every item, they are requested again as regular deltas
+		UE_LOG(LogTemp, Warning, TEXT("FPDMissionNetDataCompound::ReadInitialSnapshot -- Snapshot of %u items does not match the local missions (%u mapped), dropped it and requesting the full state"), NumItems, NumLocalMissions);
+		ArrayReplicationKey = ArrayKey;
+		if (OwnerTracker != nullptr) { OwnerTracker->RequestFullState(); }
+		return true;
+	}
+
+	// Following deltas address items by replication ID, so the item map needs to match the server
+	Items = MoveTemp(ReadItems);
+	ArrayReplicationKey = ArrayKey;
+	for (int32 ItemIndex = 0; ItemIndex < Items.Num(); ItemIndex++)
+	{
+		ItemMap.Add(Items[ItemIndex].ReplicationID, ItemIndex);
+	}
+
+	for (FPDMissionNetDatum& Item : Items)
+	{
+		Item.PostReplicatedAdd(*this);
+	}
+	return true;
+}
@@ -3,9 +3,12 @@
 #include "PDMissionCommon.h"
 
 #include "Components/PDMissionTracker.h"
+#include "Data/PDMissionStateMachine.h"
 #include "Interfaces/PDMissionInterface.h"
 #include "Subsystems/PDMissionSubsystem.h"
 
+#include <GameFramework/GameStateBase.h>
+
 //
 // Progress statics
 
@@ -22,18 +25,33 @@ FDataTableRowHandle UPDMissionStatics::CreateRowHandle(UDataTable* Table, FName
 	return RowHandle;
 }
 
+FPDMissionHandle UPDMissionStatics::ResolveMissionHandle(const FGameplayTag& MissionBaseTag)
+{
+	const UPDMissionSubsystem* MissionSubsystem = GetMissionSubsystem();
+	return MissionSubsystem != nullptr ? MissionSubsystem->Utility.ResolveHandle(MissionBaseTag) : FPDMissionHandle{};
+}
+
+double UPDMissionStatics::GetServerWorldTime(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine != nullptr ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World == nullptr) { return 0.0; }
+
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
 //
 // Mission delay functor
-FPDDelayMissionFunctor::FPDDelayMissionFunctor(UPDMissionTracker* Tracker, const FDataTableRowHandle& Target, const FPDMissionBranchBehaviour& TargetBehaviour)
+FPDDelayMissionFunctor::FPDDelayMissionFunctor(UPDMissionTracker* Tracker, const int32 TargetMID, const FPDMissionBranchBehaviour& TargetBehaviour)
 {
 	bHasRun = false;
-	const FPDMissionRow* MissionRow = Target.GetRow<FPDMissionRow>("");
-	if (Tracker == nullptr || Tracker->IsValidLowLevelFast() == false || MissionRow == nullptr || Tracker->GetWorld() == nullptr)
+	const UPDMissionSubsystem* MissionSubsystem = UPDMissionStatics::GetMissionSubsystem();
+	if (Tracker == nullptr || Tracker->IsValidLowLevelFast() == false || MissionSubsystem == nullptr || MissionSubsystem->Utility.IsValidMission(TargetMID) == false || Tracker->GetWorld() == nullptr)
 	{
 		return;
 	}
 	
-	const FGameplayTag& MissionBaseTag = MissionRow->Base.MissionBaseTag;
+	const FGameplayTag MissionBaseTag = MissionSubsystem->Utility.GetMissionBaseTag(TargetMID);
 	const FPDMissionNetDatum* MissionDatum = Tracker->GetDatum(MissionBaseTag);
 	if (MissionDatum == nullptr) { return; }
 
@@ -41,21 +59,22 @@ FPDDelayMissionFunctor::FPDDelayMissionFunctor(UPDMissionTracker* Tracker, const
 	FPDMissionNetDatum OverwriteDatum = *MissionDatum;
 	if (TargetBehaviour.DelayTime <= SMALL_NUMBER)
 	{
-		Tracker->FinalizeOverwriteRef(MissionBaseTag, OverwriteDatum, TargetBehaviour);
+		if (Tracker->FinalizeOverwriteRef(MissionBaseTag, OverwriteDatum, TargetBehaviour) == false) { return; }
 	}
 	else
 	{
-		// Set to pending state
-		OverwriteDatum.State.Current = EPDMissionState::EPending;
-		Tracker->SetMissionDatum(MissionBaseTag, OverwriteDatum);
-
-		// Dispatch timer
-		FTimerHandle SavedHandle;
-		FTimerManager& WorldTimer = Tracker->GetWorld()->GetTimerManager();
-		const FTimerDelegate Delegate = FTimerDelegate::CreateUObject(Tracker, &UPDMissionTracker::FinalizeOverwriteCopy, MissionBaseTag, OverwriteDatum, TargetBehaviour);
-		WorldTimer.SetTimer(SavedHandle, Delegate, TargetBehaviour.DelayTime, false);
-
-		OutHandlesMap.Emplace(SavedHandle, Delegate);
+		// The branch event needs to be legal now, not only once the deadline has passed
+		if (FPDMissionStateMachine::Validate(OverwriteDatum.State.Current, FPDMissionStateMachine::GetBranchEvent(TargetBehaviour.Type)) == false) { return; }
+		
+		// Set to pending state, clients count down to the deadline on their own
+		const double Deadline = UPDMissionStatics::GetServerWorldTime(Tracker) + TargetBehaviour.DelayTime;
+		if (Tracker->TransitionMission(MissionBaseTag, EEventDelay, Deadline) == false) { return; }
+
+		// Mirrored on the copy the deadline entry keeps, the branch event is applied to the tracked mission once the deadline passes
+		FPDMissionStateMachine::Apply(OverwriteDatum, EEventDelay, Deadline);
+
+		// Dispatch through the trackers deadline schedule
+		Tracker->ScheduleMissionDeadline(MissionBaseTag, OverwriteDatum, TargetBehaviour, Deadline);
 	}
 
 
@@ -72,6 +91,29 @@ void FPDMissionRules::IterateStatusHandlers(const FGameplayTag& Tag, FPDFPDMissi
 {
 }
 
+bool FPDMissionRules::CompileConditions()
+{
+	bool bSuccess = FPDMissionConditionProgram::Compile(ConditionExpression, CompiledConditionExpression);
+	for (FPDMissionBranchElement& Branch : NextMissionBranch.Branches)
+	{
+		bSuccess &= FPDMissionConditionProgram::Compile(Branch.BranchExpression, Branch.CompiledBranchExpression);
+	}
+	return bSuccess;
+}
+
+bool FPDMissionRules::EvaluateConditions(const AActor* Caller) const
+{
+	return MissionConditionHandler.CallerHasRequiredTags(Caller) && CompiledConditionExpression.Evaluate(Caller);
+}
+
+//
+// Branch element
+
+bool FPDMissionBranchElement::EvaluateConditions(const AActor* Caller) const
+{
+	return BranchConditions.CallerHasRequiredTags(Caller) && CompiledBranchExpression.Evaluate(Caller);
+}
+
 //
 // Mission base helpers
 void FPDMissionBase::ResolveMissionTypeTag()
@@ -106,13 +148,24 @@ void FPDMissionTagCompound::ClearUserTags(AActor* Caller)
 	OptionalUserTags.Empty();
 }
 
+/** @brief Set equality without building intermediary sets */
+static bool PDTagSetsEqual(const TSet<FGameplayTag>& A, const TSet<FGameplayTag>& B)
+{
+	if (A.Num() != B.Num()) { return false; }
+	for (const FGameplayTag& Tag : A)
+	{
+		if (B.Contains(Tag) == false) { return false; }
+	}
+	return true;
+}
+
 bool FPDMissionTagCompound::operator==(const FPDMissionTagCompound& Other) const
 {
-	return  OptionalUserTags.Difference(Other.OptionalUserTags).Num() == 0 && RequiredMissionTags.Difference(Other.RequiredMissionTags).Num() == 0;
+	return PDTagSetsEqual(OptionalUserTags, Other.OptionalUserTags) && PDTagSetsEqual(RequiredMissionTags, Other.RequiredMissionTags);
 }
 bool FPDMissionTagCompound::operator==(const FPDMissionTagCompound&& Other) const
 {
-	return  OptionalUserTags.Difference(Other.OptionalUserTags).Num() == 0 && RequiredMissionTags.Difference(Other.RequiredMissionTags).Num() == 0;
+	return PDTagSetsEqual(OptionalUserTags, Other.OptionalUserTags) && PDTagSetsEqual(RequiredMissionTags, Other.RequiredMissionTags);
 }
 
 bool FPDMissionTagCompound::CallerHasRequiredTags(const AActor* Caller) const
@@ -123,17 +176,19 @@ bool FPDMissionTagCompound::CallerHasRequiredTags(const AActor* Caller) const
 	}
 	
 	const IPDMissionInterface* AsInterface = Cast<const IPDMissionInterface>(Caller);
-	const TSet<FGameplayTag>& UserTagContainer = AsInterface->GetTagContainer();
+	// Expanded with parent tags, so a required 'Faction.Ally' is satisfied by 'Faction.Ally.Elves'
+	const TSet<FGameplayTag>& UserTagContainer = AsInterface->GetExpandedTagContainer();
 
-	for (const FGameplayTag& Tag : OptionalUserTags)
+	for (const FGameplayTag& Tag : RequiredMissionTags)
 	{
 		if (UserTagContainer.Contains(Tag) == false) { return false; }
 	}
 
-	for (const FGameplayTag& Tag : RequiredMissionTags)
+	// Optional tags are any-of, an empty set passes
+	if (OptionalUserTags.IsEmpty()) { return true; }
+	for (const FGameplayTag& Tag : OptionalUserTags)
 	{
-		if (UserTagContainer.Contains(Tag) == false) { return false; }
+		if (UserTagContainer.Contains(Tag)) { return true; }
 	}
-
-	return true;
+	return false;
 }
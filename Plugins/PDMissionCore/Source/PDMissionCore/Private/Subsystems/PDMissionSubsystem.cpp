@@ -4,12 +4,246 @@
 #include "Subsystems/PDMissionSubsystem.h"
 
 #include "Components/PDMissionTracker.h"
+#include "Data/PDMissionStateMachine.h"
+#include "Interfaces/PDMissionInterface.h"
+
+#include <Engine/AssetManager.h>
+#include <Engine/StreamableManager.h>
+#include <Misc/CoreDelegates.h>
 
 void UPDMissionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
 
-	Utility.InitializeMissionSubsystem();
+	Utility.InitializeMissionSubsystem(this);
+
+	// Events posted off the game thread are applied in one batch, before anything else runs this frame
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &UPDMissionSubsystem::DrainMissionEvents);
+
+	// The asset manager is not guaranteed to exist yet this early, defer the initial group requests until it does
+	if (UAssetManager::IsInitialized())
+	{
+		LoadInitialMissionTableGroups();
+	}
+	else
+	{
+		FCoreDelegates::OnPostEngineInit.AddUObject(this, &UPDMissionSubsystem::LoadInitialMissionTableGroups);
+	}
+}
+
+void UPDMissionSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	QueuedMissionEvents.Empty();
+	Utility.Preloader.Reset();
+	Utility.UnbindAllMissionTablesChanged();
+	
+	Super::Deinitialize();
+}
+
+void UPDMissionSubsystem::PostMissionEvent(FPDQueuedMissionEvent&& Event)
+{
+	QueuedMissionEvents.Enqueue(MoveTemp(Event));
+}
+
+void UPDMissionSubsystem::DrainMissionEvents()
+{
+	check(IsInGameThread());
+	if (QueuedMissionEvents.IsEmpty()) { return; }
+
+	// Every tracker touched by the batch coalesces its changes, and flushes them once at the end. Held weakly, an event may destroy a tracker
+	TMap<TWeakObjectPtr<UPDMissionTracker>, bool> TouchedTrackers;
+	const auto TouchTracker = [&TouchedTrackers](UPDMissionTracker* Tracker)
+	{
+		if (TouchedTrackers.Contains(Tracker)) { return; }
+		
+		TouchedTrackers.Add(Tracker, Tracker->bCoalesceUpdates);
+		Tracker->bCoalesceUpdates = true;
+	};
+	
+	FPDQueuedMissionEvent Event;
+	while (QueuedMissionEvents.Dequeue(Event))
+	{
+		UPDMissionTracker* Tracker = Utility.GetActorTracker(Event.ActorID);
+		if (Tracker == nullptr) { continue; } // Deregistered since it was posted
+
+		// Shared missions are written to the group tracker, it coalesces the same as the members own tracker
+		TouchTracker(Tracker);
+		const int32 mID = Event.Tag.IsValid() ? Utility.ResolveMIDViaTag(Event.Tag) : INDEX_NONE;
+		UPDMissionTracker* OwningTracker = mID != INDEX_NONE ? Tracker->ResolveOwningTracker(mID) : Tracker;
+		if (OwningTracker != Tracker) { TouchTracker(OwningTracker); }
+		
+		ApplyMissionEvent(Event);
+	}
+
+	for (const TPair<TWeakObjectPtr<UPDMissionTracker>, bool>& Touched : TouchedTrackers)
+	{
+		UPDMissionTracker* TouchedTracker = Touched.Key.Get();
+		if (TouchedTracker == nullptr) { continue; }
+		
+		TouchedTracker->bCoalesceUpdates = Touched.Value;
+		if (Touched.Value == false) { TouchedTracker->FlushPendingChanges(); }
+	}
+}
+
+void UPDMissionSubsystem::OnMissionTableChanged(const int32 TableID)
+{
+	Utility.OnMissionTableChanged(TableID);
+}
+
+void UPDMissionSubsystem::ApplyMissionEvent(const FPDQueuedMissionEvent& Event)
+{
+	UPDMissionTracker* Tracker = Utility.GetActorTracker(Event.ActorID);
+	AActor* TrackerOwner = Tracker != nullptr ? Tracker->GetOwner() : nullptr;
+	if (TrackerOwner == nullptr) { return; }
+
+	switch (Event.Type)
+	{
+	case EQueuedTransition:
+		if (Tracker->GetDatum(Event.Tag) == nullptr) { return; }
+		Tracker->TransitionMission(Event.Tag, Event.Transition);
+		break;
+	case EQueuedFinish:
+		FinishMission(Event.ActorID, FPDMissionBase{Event.Tag, Utility.ResolveMIDViaTag(Event.Tag)});
+		break;
+	case EQueuedAddTags:
+	case EQueuedRemoveTags:
+		{
+			if (TrackerOwner->Implements<UPDMissionInterface>() == false) { return; }
+
+			TArray<FGameplayTag> Tags = Event.Tags;
+			if (Event.Type == EQueuedAddTags) { IPDMissionInterface::Execute_AddTagsToContainer(TrackerOwner, Tags); }
+			else { IPDMissionInterface::Execute_RemoveTagsToContainer(TrackerOwner, Tags); }
+		}
+		break;
+	default: ;
+	}
+}
+
+void UPDMissionSubsystem::LoadInitialMissionTableGroups()
+{
+	for (const FPDMissionTableGroup& Group : Utility.MissionTableGroups)
+	{
+		if (Group.bLoadOnInitialize) { LoadMissionTableGroup(Group.GroupTag); }
+	}
+}
+
+bool UPDMissionSubsystem::LoadMissionTableGroup(const FGameplayTag& GroupTag)
+{
+	const FPDMissionTableGroup* Group = Utility.FindTableGroup(GroupTag);
+	if (Group == nullptr || UAssetManager::IsInitialized() == false)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UPDMissionSubsystem::LoadMissionTableGroup -- Group(%s) valid: %i, AssetManager initialized: %i"),
+			*GroupTag.ToString(), Group != nullptr, UAssetManager::IsInitialized());
+		return false;
+	}
+
+	FPDMissionTableGroupState& GroupState = Utility.TableGroupStates.FindOrAdd(GroupTag);
+	if (GroupState.StreamingHandle.IsValid()) { return false; } // Already requested or loaded
+
+	TArray<FSoftObjectPath> TablePaths;
+	for (const TSoftObjectPtr<UDataTable>& Table : Group->Tables)
+	{
+		if (Table.IsNull() == false) { TablePaths.Add(Table.ToSoftObjectPath()); }
+	}
+	if (TablePaths.IsEmpty()) { return false; }
+
+	GroupState.StreamingHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		TablePaths,
+		FStreamableDelegate::CreateUObject(this, &UPDMissionSubsystem::OnMissionTableGroupLoaded, GroupTag),
+		FStreamableManager::AsyncLoadHighPriority);
+
+	return GroupState.StreamingHandle.IsValid();
+}
+
+void UPDMissionSubsystem::OnMissionTableGroupLoaded(FGameplayTag GroupTag)
+{
+	const FPDMissionTableGroupState* GroupState = Utility.TableGroupStates.Find(GroupTag);
+	if (GroupState == nullptr || GroupState->StreamingHandle.IsValid() == false) { return; } // Unloaded before the request finished
+
+	TArray<UObject*> LoadedAssets;
+	GroupState->StreamingHandle->GetLoadedAssets(LoadedAssets);
+
+	TArray<UDataTable*> LoadedTables;
+	for (UObject* LoadedAsset : LoadedAssets)
+	{
+		UDataTable* AsTable = Cast<UDataTable>(LoadedAsset);
+		if (AsTable != nullptr && AsTable->GetRowStruct() == FPDMissionRow::StaticStruct()) { LoadedTables.Add(AsTable); }
+	}
+
+	Utility.MergeTableGroup(GroupTag, LoadedTables);
+}
+
+bool UPDMissionSubsystem::UnloadMissionTableGroup(const FGameplayTag& GroupTag)
+{
+	FPDMissionTableGroupState* GroupState = Utility.TableGroupStates.Find(GroupTag);
+	if (GroupState == nullptr || GroupState->StreamingHandle.IsValid() == false) { return false; }
+
+	// Still in-flight, cancel it instead
+	if (Utility.IsTableGroupLoaded(GroupTag) == false)
+	{
+		GroupState->StreamingHandle->CancelHandle();
+		GroupState->StreamingHandle.Reset();
+		return true;
+	}
+
+	GroupState->StreamingHandle->ReleaseHandle();
+	return Utility.UnmergeTableGroup(GroupTag);
+}
+
+bool UPDMissionSubsystem::IsMissionTableGroupLoaded(const FGameplayTag& GroupTag) const
+{
+	return Utility.IsTableGroupLoaded(GroupTag);
+}
+
+FPDMissionMetadata UPDMissionSubsystem::GetMissionMetadata(const FGameplayTag& MissionBaseTag) const
+{
+	return Utility.GetMetadataBaseViaTag(MissionBaseTag);
+}
+
+int32 UPDMissionSubsystem::CountActorsInMissionState(const FGameplayTag& MissionBaseTag, TEnumAsByte<EPDMissionState> State) const
+{
+	return Utility.CountActorsInState(Utility.ResolveMIDViaTag(MissionBaseTag), State);
+}
+
+TArray<int32> UPDMissionSubsystem::GetActorsInMissionState(const FGameplayTag& MissionBaseTag, TEnumAsByte<EPDMissionState> State) const
+{
+	const int32 mID = Utility.ResolveMIDViaTag(MissionBaseTag);
+	
+	TArray<int32> ActorIDs;
+	ActorIDs.Reserve(Utility.CountActorsInState(mID, State));
+	Utility.ForEachActorInState(mID, State, [&ActorIDs](const int32 ActorID) { ActorIDs.Add(ActorID); });
+	return ActorIDs;
+}
+
+TArray<FGameplayTag> UPDMissionSubsystem::DrawMissionsFromPool(int32 ActorID, const FGameplayTag& PoolTag, int32 Count, int32 Seed)
+{
+	TArray<int32> DrawnMIDs;
+	Utility.DrawMissionsFromPool(ActorID, PoolTag, Count, FRandomStream{Seed}, DrawnMIDs);
+	return ResolveMissionTags(DrawnMIDs);
+}
+
+TArray<FGameplayTag> UPDMissionSubsystem::GetMissionRotation(const FGameplayTag& RotationTag, FDateTime UtcTime, int32 Salt)
+{
+	TArray<int32> RotationMIDs;
+	Utility.GetMissionRotation(RotationTag, UtcTime, Salt, RotationMIDs);
+	return ResolveMissionTags(RotationMIDs);
+}
+
+bool UPDMissionSubsystem::PrecomputeMissionRotation(const FGameplayTag& RotationTag, FDateTime UtcTime, int32 Salt)
+{
+	return Utility.PrecomputeMissionRotation(RotationTag, UtcTime, Salt);
+}
+
+TArray<FGameplayTag> UPDMissionSubsystem::ResolveMissionTags(const TArray<int32>& MIDs) const
+{
+	TArray<FGameplayTag> MissionTags;
+	MissionTags.Reserve(MIDs.Num());
+	for (const int32 mID : MIDs)
+	{
+		if (Utility.IsValidMission(mID)) { MissionTags.Add(Utility.GetMissionBaseTag(mID)); }
+	}
+	return MissionTags;
 }
 
 void UPDMissionSubsystem::SetMission(int32 ActorID, const FPDMissionBase& PersistentDatum)
@@ -18,63 +252,56 @@ void UPDMissionSubsystem::SetMission(int32 ActorID, const FPDMissionBase& Persis
 
 bool UPDMissionSubsystem::FinishMission(int32 ActorID, const FPDMissionBase& PersistentDatum)
 {
-	const FPDMissionRow* DefaultData = Utility.GetDefaultBase(PersistentDatum.mID);
+	const int32 mID = PersistentDatum.mID;
+	const bool bIsValidMission = Utility.IsValidMission(mID);
 	UPDMissionTracker* Tracker = Utility.GetActorTracker(ActorID);
+	
+	// Shared missions are finished on the group copy, against the aggregated tags of the group
+	Tracker = Tracker != nullptr ? Tracker->ResolveOwningTracker(mID) : nullptr;
 	const AActor* TrackerOwner = Tracker != nullptr ? Tracker->GetOwner() : nullptr;
-	if (DefaultData == nullptr || TrackerOwner  == nullptr)
+	if (bIsValidMission == false || TrackerOwner  == nullptr)
 	{
-		UE_LOG(LogTemp, Error, TEXT("Tracker valid: %i, Tracker Owner valid: %i ,  DefaultData valid: %i"),
-			Tracker != nullptr, TrackerOwner != nullptr, DefaultData != nullptr);
+		UE_LOG(LogTemp, Error, TEXT("Tracker valid: %i, Tracker Owner valid: %i ,  Mission valid: %i"),
+			Tracker != nullptr, TrackerOwner != nullptr, bIsValidMission);
 		return false;
 	}
 
 	// can't set mission progress, does not have required tags too finish the mission 
-	if (DefaultData->ProgressRules.MissionConditionHandler.CallerHasRequiredTags(TrackerOwner) == false)
+	if (Utility.EvaluateMissionConditions(TrackerOwner, mID) == false)
 	{
 		return false;
 	}
 
-	switch (Tracker->GetDatum(PersistentDatum.mID)->State.Current)
-	{
-	case ECompleted:
-	case EFailed:
-		// @todo Complete/Fail path needs to check if it is repeatable and if yes, how long should it be delayed
-		return false;
-	case EPending:
-		// Avoid re-triggering while pending
-		return false;
-	case ELocked:
-		// @todo Locked path needs to check if conditions for immediate or delayed 'unlocking + completion' have been met  
-		return false;
-	case EInactive:
-		// @todo Inactive path needs to check if conditions for immediate or delayed 'unlocking + completion' have been met		return false;
-		return false;
-	case EActive:
-		break;
-	default: ;
-	}
+	// Only active missions may be finished, see FPDMissionStateMachine::Transitions. Finished repeatable missions wait for their cooldown to reset them
+	// @todo Locked/Inactive paths need to check if conditions for immediate or delayed 'unlocking + completion' have been met
+	const FPDMissionNetDatum* CurrentDatum = Tracker->GetDatum(mID);
+	if (CurrentDatum == nullptr) { return false; }
+	
+	if (FPDMissionStateMachine::Validate(CurrentDatum->State.Current, EEventComplete) == false) { return false; }
 
-	const TArray<FPDMissionBranchElement>& BranchRef = DefaultData->ProgressRules.NextMissionBranch.Branches;
-	const bool MissionHasBranches = BranchRef.IsEmpty() == false;
+	// Completing sets the cooldown expiry of repeatable missions as its deadline, see ETransitionEffect_SetCooldown
+	const bool bRepeatable = Utility.IsRepeatable(mID);
+	const double CooldownExpiry = UPDMissionStatics::GetServerWorldTime(Tracker) + Utility.GetRepeatCooldown(mID);
+
+	const int32 NumBranches = Utility.GetNumBranches(mID);
+	const bool MissionHasBranches = NumBranches > 0;
+	
+	// Immediate branch changes are applied together with a single replication update
+	const bool bOpenedTransaction = Tracker->BeginMissionTransaction();
 	
 	FPDDelayMissionFunctor NewMissionDispatch;
-	const int32 LastIdx = BranchRef.Num() - 1;
-	TArray<FTimerHandle> OutHandles{};
-	OutHandles.SetNum(BranchRef.Num());
-	TMap<FTimerHandle, FTimerDelegate> OutHandlesMap{}; // make hashable if not already
+	const int32 LastIdx = NumBranches - 1;
 	
 	for (int32 Idx = 0; Idx <= LastIdx; Idx++)
 	{
-		const FPDMissionBranchElement& CurrentBranch = BranchRef[Idx];
-		
 		// Pick first branch we match against, skip any up until that point
-		if (CurrentBranch.BranchConditions.CallerHasRequiredTags(TrackerOwner) == false)
+		if (Utility.EvaluateBranchConditions(TrackerOwner, mID, Idx) == false)
 		{
 			continue;
 		}
 		
-		// @todo Delay system? mission timer manager? will think on it a little
-		NewMissionDispatch = FPDDelayMissionFunctor{Tracker, CurrentBranch.Target, CurrentBranch.TargetBehaviour};
+		// Delayed branches are scheduled on the trackers deadline schedule, immediate ones are applied right away
+		NewMissionDispatch = FPDDelayMissionFunctor{Tracker, Utility.GetBranchTargetMID(mID, Idx), Utility.GetBranchBehaviour(mID, Idx)};
 		break; // exit loop after constructing the functor
 	}
 
@@ -82,23 +309,28 @@ bool UPDMissionSubsystem::FinishMission(int32 ActorID, const FPDMissionBase& Per
 	// and fix their mission rules as the current settings has gotten it soft-locked
 	if (NewMissionDispatch.bHasRun == false && MissionHasBranches)
 	{
+		if (bOpenedTransaction) { Tracker->AbortMissionTransaction(); }
 		UE_LOG(LogTemp, Error, TEXT("CRITICAL ERROR; SOFTLOCK. NO BRANCHING PATH MET CONDITIONS TO BRANCH."));
 		return false;
 	}
 
-	for (const TPair<FTimerHandle, FTimerDelegate>& TimerHandle : NewMissionDispatch.OutHandlesMap)
+	// Completed together with the branch changes, in the same transaction
+	if (Tracker->TransitionMission(Utility.GetMissionBaseTag(mID), EEventComplete, bRepeatable ? CooldownExpiry : 0.0) == false)
 	{
-		if (TimerHandle.Key.IsValid() == false) { continue; }
+		if (bOpenedTransaction) { Tracker->AbortMissionTransaction(); }
+		return false;
+	}
 
-		// Timer is valid,
-		// @todo Start: 1. Store the handles so we can later make
-		// @todo Cont.: 2  Delay for given time
-		// @todo Cont.: 3. When exiting game, before destroying the UWorld,
-		// @todo Cont.: 4. Check which timers have remaining time left by using the stored handles,
-		// @todo Cont.: 5. Store their remaining time alongside with timer delegate parameters and delegate in a format that we'll serialize 
+	// A transaction opened by the caller is left for the caller to commit
+	if (bOpenedTransaction && Tracker->CommitMissionTransaction() == false)
+	{
+		return false;
 	}
-	
 
+	// Re-armed through the trackers shared deadline timer, a stale cooldown is ignored if the transaction is dropped by the caller
+	if (bRepeatable) { Tracker->ScheduleMissionCooldown(mID, CooldownExpiry); }
+
+	// @todo Pending deadlines live on the tracked datums, serialize their remaining time alongside the datums when saving
 	
 	return true; // Either successfully passed to another branch or no branch left and was last mission in the current branching path 
 }
@@ -1,29 +1,57 @@
 /* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
 
 #include "Subsystems/PDMissionUtility.h"
+#include "Subsystems/PDMissionSubsystem.h"
 #include "Components/PDMissionTracker.h"
 #include "Net/MissionDatum.h"
+#include "Data/PDMissionDatabase.h"
+#include "Interfaces/PDMissionInterface.h"
 
 #include <Curves/CurveFloat.h>
+#include <Async/Async.h>
+#include <Engine/AssetManager.h>
+#include <Engine/StreamableManager.h>
+#include <Engine/NetConnection.h>
 
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Factories/DataTableFactory.h"
 
 const FPDMissionMetadata& FPDMissionUtility::GetMetadataBase(const int32 mID) const
 {
-	FPDMissionRow* StatRow = GetDefaultBase(mID);
+	// Missions served from the compiled database keep their metadata in the cold store, only pulled in the first time something asks for it
+	if (IsCompiledMission(mID))
+	{
+		if (LoadedMetadataStore == nullptr)
+		{
+			LoadedMetadataStore = LoadedDatabase->LoadMetadataStore();
+		}
+		const FPDMissionMetadata* Metadata = LoadedMetadataStore != nullptr ? LoadedMetadataStore->GetMetadata(mID) : nullptr;
+		return Metadata != nullptr ? *Metadata : DummyMetadata;
+	}
+
+	// Table rows carry their own metadata, in the editor as well as in cooked builds without a compiled database
+	const FPDMissionRow* StatRow = GetDefaultBase(mID);
 	return StatRow != nullptr ? StatRow->Metadata : DummyMetadata;
 }
 
 const FPDMissionMetadata& FPDMissionUtility::GetMetadataBaseViaTag(const FGameplayTag& BaseTag) const
 {
-	FPDMissionRow* MissionRow = GetDefaultBaseViaTag(BaseTag);
-	return MissionRow != nullptr ? MissionRow->Metadata : DummyMetadata;
+	return GetMetadataBase(ResolveMIDViaTag(BaseTag));
+}
+
+FPDMissionTagSetHandle FPDMissionUtility::GetConditionHandle(const int32 mID) const
+{
+	return DenseConditionHandles.IsValidIndex(mID - 1) ? DenseConditionHandles[mID - 1] : FPDMissionTagSetHandle{};
 }
 
 bool FPDMissionUtility::IsValidMission(const int32 SID) const
 {
-	return MissionLookup.Contains(SID);
+	return IsCompiledMission(SID) || (DenseMissionRows.IsValidIndex(SID - 1) && DenseMissionRows[SID - 1] != nullptr);
+}
+
+bool FPDMissionUtility::IsCompiledMission(const int32 mID) const
+{
+	return LoadedDatabase != nullptr && LoadedDatabase->IsValidMID(mID);
 }
 
 bool FPDMissionUtility::IsValidMissionViaTag(const FGameplayTag& BaseTag) const
@@ -36,22 +64,95 @@ int32 FPDMissionUtility::ResolveMIDViaTag(const FGameplayTag& BaseTag) const
 	return MissionTagToMIDLookup.Contains(BaseTag) ? *MissionTagToMIDLookup.Find(BaseTag) : INDEX_NONE;
 }
 
+int32 FPDMissionUtility::ResolveMIDViaRowName(const FName& RowName) const
+{
+	const int32* FoundMID = MissionRowNameToMIDLookup.Find(RowName);
+	return FoundMID != nullptr ? *FoundMID : INDEX_NONE;
+}
+
 FPDMissionRow* FPDMissionUtility::GetDefaultBase(const int32 SID) const
 {
-	const FDataTableRowHandle* RowHandle = MissionLookup.Find(SID);
-	if (RowHandle == nullptr) { return nullptr; }
+	// Served from the dense row cache, which only holds table rows
+	return DenseMissionRows.IsValidIndex(SID - 1) ? DenseMissionRows[SID - 1] : nullptr;
+}
+
+FGameplayTag FPDMissionUtility::GetMissionBaseTag(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetTag(LoadedDatabase->GetLookup(mID)->TagString); }
 
-	return RowHandle->GetRow<FPDMissionRow>(FString::Printf(TEXT("GetDefaultBase() - MID: %i"), SID));
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? MissionRow->Base.MissionBaseTag : FGameplayTag::EmptyTag;
 }
 
-FPDMissionRow* FPDMissionUtility::GetDefaultBaseViaTag(const FGameplayTag& BaseTag) const
+FGameplayTag FPDMissionUtility::GetMissionTypeTag(const int32 mID) const
 {
-	const int32* MID = MissionTagToMIDLookup.Find(BaseTag);
-	const FDataTableRowHandle* RowHandle = MissionLookup.Find(MID != nullptr ? *MID : INDEX_NONE);
-	
-	if (RowHandle == nullptr) { return nullptr; }
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetTag(LoadedDatabase->GetLookup(mID)->TypeTagString); }
+
+	FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? MissionRow->Base.GetMissionTypeTag() : FGameplayTag::EmptyTag;
+}
+
+EPDMissionState FPDMissionUtility::GetStartState(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetStartState(mID); }
+
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? MissionRow->ProgressRules.EStartState.GetValue() : EPDMissionState::EINVALID_STATE;
+}
+
+bool FPDMissionUtility::IsRepeatable(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->HasFlag(mID, ECompiledFlag_Repeatable); }
+
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr && MissionRow->ProgressRules.bRepeatable;
+}
 
-	return RowHandle->GetRow<FPDMissionRow>(FString::Printf(TEXT("GetDefaultBase() - MID: %i"), *MID));
+float FPDMissionUtility::GetRepeatCooldown(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetRepeatCooldown(mID); }
+
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? MissionRow->ProgressRules.RepeatCooldown : 0.0f;
+}
+
+int32 FPDMissionUtility::GetNumBranches(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetBranches(mID).Num(); }
+
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? MissionRow->ProgressRules.NextMissionBranch.Branches.Num() : 0;
+}
+
+int32 FPDMissionUtility::GetBranchTargetMID(const int32 mID, const int32 BranchIdx) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetBranches(mID)[BranchIdx].TargetMID; }
+
+	return GetDefaultBase(mID)->ProgressRules.NextMissionBranch.Branches[BranchIdx].TargetMID;
+}
+
+FPDMissionBranchBehaviour FPDMissionUtility::GetBranchBehaviour(const int32 mID, const int32 BranchIdx) const
+{
+	if (IsCompiledMission(mID) == false) { return GetDefaultBase(mID)->ProgressRules.NextMissionBranch.Branches[BranchIdx].TargetBehaviour; }
+
+	const FPDCompiledMissionBranch& CompiledBranch = LoadedDatabase->GetBranches(mID)[BranchIdx];
+	FPDMissionBranchBehaviour Behaviour;
+	Behaviour.Type = static_cast<EPDMissionBranchBehaviour>(CompiledBranch.Type);
+	Behaviour.DelayTime = CompiledBranch.DelayTime;
+	return Behaviour;
+}
+
+TConstArrayView<TSoftObjectPtr<UObject>> FPDMissionUtility::GetPreloadAssets(const int32 mID) const
+{
+	if (IsCompiledMission(mID)) { return LoadedDatabase->GetPreloadAssets(mID); }
+
+	const FPDMissionRow* MissionRow = GetDefaultBase(mID);
+	return MissionRow != nullptr ? TConstArrayView<TSoftObjectPtr<UObject>>(MissionRow->PreloadAssets) : TConstArrayView<TSoftObjectPtr<UObject>>();
+}
+
+FPDMissionRow* FPDMissionUtility::GetDefaultBaseViaTag(const FGameplayTag& BaseTag) const
+{
+	return GetDefaultBase(ResolveMIDViaTag(BaseTag));
 }
 
 FPDMissionRules* FPDMissionUtility::GetMissionRules(const int32 SID) const
@@ -68,12 +169,45 @@ FPDMissionRules* FPDMissionUtility::GetMissionRulesViaTag(const FGameplayTag& Ba
 
 UPDMissionTracker* FPDMissionUtility::GetActorTracker(int32 ActorID) const
 {
-	UPDMissionTracker* const* MissionMap = MissionTrackerMap.Find(ActorID);
-	if (MissionMap == nullptr || (*MissionMap) == nullptr || (*MissionMap)->IsValidLowLevel() == false)
-	{
-		return nullptr;
-	}
-	return *MissionMap;
+	const int32 Slot = FPDMissionActorIDAllocator::GetSlot(ActorID);
+	if (ActorIDAllocator.IsValid(ActorID) == false || MissionTrackers.IsValidIndex(Slot) == false) { return nullptr; }
+
+	// The generation check above is enough, slots are nulled from the trackers OnUnregister before the tracker can be collected
+	return MissionTrackers[Slot];
+}
+
+FPDMissionHandle FPDMissionUtility::ResolveHandle(const FGameplayTag& BaseTag) const
+{
+	return ResolveHandleViaMID(ResolveMIDViaTag(BaseTag));
+}
+
+FPDMissionHandle FPDMissionUtility::ResolveHandleViaMID(const int32 mID) const
+{
+	if (IsValidMission(mID) == false) { return FPDMissionHandle{}; }
+
+	return FPDMissionHandle{mID - 1, DatabaseGeneration};
+}
+
+bool FPDMissionUtility::IsValidHandle(const FPDMissionHandle& Handle) const
+{
+	return Handle.Generation == DatabaseGeneration && IsValidMission(Handle.Index + 1);
+}
+
+FPDMissionRow* FPDMissionUtility::GetDefaultBase(const FPDMissionHandle& Handle) const
+{
+	return IsValidHandle(Handle) ? DenseMissionRows[Handle.Index] : nullptr;
+}
+
+FPDMissionRules* FPDMissionUtility::GetMissionRules(const FPDMissionHandle& Handle) const
+{
+	FPDMissionRow* MissionRow = GetDefaultBase(Handle);
+	return MissionRow != nullptr ? &MissionRow->ProgressRules : nullptr;
+}
+
+FPDMissionNetDatum* FPDMissionUtility::GetMissionDatum(int32 ActorID, const FPDMissionHandle& Handle) const
+{
+	const UPDMissionTracker* MissionTracker = GetActorTracker(ActorID);
+	return MissionTracker != nullptr ? const_cast<FPDMissionNetDatum*>(MissionTracker->GetDatum(Handle)) : nullptr;
 }
 
 float FPDMissionUtility::CurrentMissionPercentage(const FGameplayTag& BaseTag, int32 ActorID) const
@@ -99,29 +233,440 @@ FPDMissionNetDatum* FPDMissionUtility::GetMissionDatum(int32 ActorID, int32 SID)
 
 void FPDMissionUtility::SetNewMissionDatum(UPDMissionTracker* MissionTracker, int32 SID, const FPDMissionNetDatum& Datum) const
 {
-	MissionTracker->SetMissionDatum(GetDefaultBase(SID)->Base.MissionBaseTag, Datum);
+	MissionTracker->SetMissionDatum(GetMissionBaseTag(SID), Datum);
 }
 
 void FPDMissionUtility::OverwriteMissionDatum(UPDMissionTracker* MissionTracker, int32 SID, const FPDMissionNetDatum& NewDatum, bool ForceDefault) const
 {
-	const FPDMissionRow* DefaultMissionBaseDatum = GetDefaultBase(SID);
-	
-	ForceDefault = ForceDefault && DefaultMissionBaseDatum != nullptr;
+	ForceDefault = ForceDefault && IsValidMission(SID);
 	FPDMissionNetDatum Datum;
 		Datum.mID = SID;
-		Datum.State.Current = ForceDefault ? DefaultMissionBaseDatum->ProgressRules.EStartState : NewDatum.State.Current;
-		Datum.State.MissionConditionHandler = ForceDefault ? DefaultMissionBaseDatum->ProgressRules.MissionConditionHandler : NewDatum.State.MissionConditionHandler;
+		Datum.State.Current = ForceDefault ? GetStartState(SID) : NewDatum.State.Current;
+		Datum.State.MissionConditionHandle = ForceDefault ? GetConditionHandle(SID) : NewDatum.State.MissionConditionHandle;
 	
 	SetNewMissionDatum(MissionTracker, SID, Datum);
 }
 
 
 
+//
+// ACTORID ALLOCATOR
+
+int32 FPDMissionActorIDAllocator::Allocate()
+{
+	int32 Slot = INDEX_NONE;
+	if (FreeSlots.IsEmpty() == false)
+	{
+		Slot = FreeSlots.Pop(false);
+	}
+	else
+	{
+		if (Generations.Num() > SlotMask) { return INDEX_NONE; }
+		
+		Slot = Generations.Add(1);
+		bSlotInUse.Add(false);
+	}
+
+	bSlotInUse[Slot] = true;
+	return MakeActorID(Slot, Generations[Slot]);
+}
+
+bool FPDMissionActorIDAllocator::Release(const int32 ActorID)
+{
+	if (IsValid(ActorID) == false) { return false; }
+
+	const int32 Slot = GetSlot(ActorID);
+	bSlotInUse[Slot] = false;
+	
+	// Wrap around, skipping 0 so a valid ActorID never packs into 0
+	Generations[Slot] = Generations[Slot] >= GenerationMask ? 1 : Generations[Slot] + 1;
+	FreeSlots.Push(Slot);
+	return true;
+}
+
+//
+// STATE INDEX
+
+void FPDMissionStateIndex::Add(const int32 DenseIndex, const EPDMissionState State, const int32 Slot)
+{
+	if (DenseIndex < 0 || Slot < 0 || IsIndexedState(State) == false) { return; }
+
+	const int32 Key = MakeKey(DenseIndex, State);
+	if (SlotSets.Num() <= Key)
+	{
+		SlotSets.SetNum(Key + 1);
+		Counts.SetNumZeroed(Key + 1);
+	}
+
+	TBitArray<>& SlotSet = SlotSets[Key];
+	if (SlotSet.Num() <= Slot)
+	{
+		SlotSet.Add(false, Slot + 1 - SlotSet.Num());
+	}
+	if (SlotSet[Slot]) { return; }
+	
+	SlotSet[Slot] = true;
+	Counts[Key]++;
+}
+
+void FPDMissionStateIndex::Remove(const int32 DenseIndex, const EPDMissionState State, const int32 Slot)
+{
+	if (DenseIndex < 0 || Slot < 0 || IsIndexedState(State) == false) { return; }
+	
+	const int32 Key = MakeKey(DenseIndex, State);
+	if (SlotSets.IsValidIndex(Key) == false || SlotSets[Key].IsValidIndex(Slot) == false || SlotSets[Key][Slot] == false) { return; }
+	
+	SlotSets[Key][Slot] = false;
+	Counts[Key]--;
+}
+
+int32 FPDMissionStateIndex::Num(const int32 DenseIndex, const EPDMissionState State) const
+{
+	if (DenseIndex < 0 || IsIndexedState(State) == false) { return 0; }
+	
+	const int32 Key = MakeKey(DenseIndex, State);
+	return Counts.IsValidIndex(Key) ? Counts[Key] : 0;
+}
+
+const TBitArray<>* FPDMissionStateIndex::Find(const int32 DenseIndex, const EPDMissionState State) const
+{
+	if (DenseIndex < 0 || IsIndexedState(State) == false) { return nullptr; }
+	
+	const int32 Key = MakeKey(DenseIndex, State);
+	return SlotSets.IsValidIndex(Key) ? &SlotSets[Key] : nullptr;
+}
+
+void FPDMissionStateIndex::Reset()
+{
+	SlotSets.Reset();
+	Counts.Reset();
+}
+
+//
+// CONDITION CACHE
+
+bool FPDMissionConditionCache::Find(const AActor* Actor, const uint32 TagVersion, const int32 Generation, const int32 ConditionID, bool& bOutResult) const
+{
+	const FActorEntry* Entry = Entries.Find(Actor);
+	if (Entry == nullptr || Entry->TagVersion != TagVersion || Entry->Generation != Generation) { return false; }
+	if (Entry->bEvaluated.IsValidIndex(ConditionID) == false || Entry->bEvaluated[ConditionID] == false) { return false; }
+
+	bOutResult = Entry->bResults[ConditionID];
+	return true;
+}
+
+void FPDMissionConditionCache::Store(const AActor* Actor, const uint32 TagVersion, const int32 Generation, const int32 ConditionID, const bool bResult)
+{
+	if (Actor == nullptr || ConditionID < 0) { return; }
+	
+	FActorEntry& Entry = Entries.FindOrAdd(Actor);
+	if (Entry.TagVersion != TagVersion || Entry.Generation != Generation)
+	{
+		// Keeps the allocations, the next version will usually need the same amount of bits
+		Entry.bEvaluated.SetRange(0, Entry.bEvaluated.Num(), false);
+		Entry.TagVersion = TagVersion;
+		Entry.Generation = Generation;
+	}
+
+	if (Entry.bEvaluated.Num() <= ConditionID)
+	{
+		Entry.bEvaluated.Add(false, ConditionID + 1 - Entry.bEvaluated.Num());
+		Entry.bResults.Add(false, ConditionID + 1 - Entry.bResults.Num());
+	}
+	Entry.bEvaluated[ConditionID] = true;
+	Entry.bResults[ConditionID] = bResult;
+}
+
+void FPDMissionConditionCache::Remove(const AActor* Actor)
+{
+	Entries.Remove(Actor);
+}
+
+void FPDMissionConditionCache::Reset()
+{
+	Entries.Reset();
+}
+
+void FPDMissionUtility::UpdateMissionStateIndex(const int32 ActorID, const int32 mID, const EPDMissionState OldState, const EPDMissionState NewState)
+{
+	if (ActorIDAllocator.IsValid(ActorID) == false || OldState == NewState) { return; }
+
+	const int32 Slot = FPDMissionActorIDAllocator::GetSlot(ActorID);
+	MissionStateIndex.Remove(mID - 1, OldState, Slot);
+	MissionStateIndex.Add(mID - 1, NewState, Slot);
+}
+
+bool FPDMissionUtility::EvaluateMissionConditions(const AActor* Caller, const int32 mID)
+{
+	return EvaluateConditions(Caller, mID, INDEX_NONE);
+}
+
+bool FPDMissionUtility::EvaluateBranchConditions(const AActor* Caller, const int32 mID, const int32 BranchIdx)
+{
+	return EvaluateConditions(Caller, mID, BranchIdx);
+}
+
+bool FPDMissionUtility::EvaluateConditions(const AActor* Caller, const int32 mID, const int32 BranchIdx)
+{
+	if (IsValidMission(mID) == false) { return false; }
+	
+	const IPDMissionInterface* AsInterface = Caller != nullptr && Caller->Implements<UPDMissionInterface>() ? Cast<const IPDMissionInterface>(Caller) : nullptr;
+	if (AsInterface == nullptr) { return EvaluateConditionsUncached(Caller, AsInterface, mID, BranchIdx); }
+
+	// The branches ids follow the missions own id, INDEX_NONE lands on the mission itself
+	const int32 ConditionID = DenseConditionIDs[mID - 1] + 1 + BranchIdx;
+	bool bResult = false;
+	if (ConditionCache.Find(Caller, AsInterface->GetTagContainerVersion(), DatabaseGeneration, ConditionID, bResult)) { return bResult; }
+
+	bResult = EvaluateConditionsUncached(Caller, AsInterface, mID, BranchIdx);
+	ConditionCache.Store(Caller, AsInterface->GetTagContainerVersion(), DatabaseGeneration, ConditionID, bResult);
+	return bResult;
+}
+
+bool FPDMissionUtility::EvaluateConditionsUncached(const AActor* Caller, const IPDMissionInterface* AsInterface, const int32 mID, const int32 BranchIdx) const
+{
+	if (IsCompiledMission(mID) == false)
+	{
+		const FPDMissionRules& Rules = GetDefaultBase(mID)->ProgressRules;
+		return BranchIdx == INDEX_NONE ? Rules.EvaluateConditions(Caller) : Rules.NextMissionBranch.Branches[BranchIdx].EvaluateConditions(Caller);
+	}
+
+	// Compiled missions carry no tag compound nor program of their own, tags and expression are tested straight against the compiled condition arrays
+	const int32 ConditionIndex = BranchIdx == INDEX_NONE ? LoadedDatabase->GetConditionIndex(mID) : LoadedDatabase->GetBranches(mID)[BranchIdx].Condition;
+	if (ConditionIndex == INDEX_NONE) { return true; }
+	
+	return AsInterface != nullptr && LoadedDatabase->EvaluateCondition(ConditionIndex, AsInterface->GetTagContainer(), AsInterface->GetExpandedTagContainer());
+}
+
+const FPDMissionPool* FPDMissionUtility::FindMissionPool(const FGameplayTag& PoolTag)
+{
+	if (CompiledMissionPoolsGeneration != DatabaseGeneration)
+	{
+		CompiledMissionPools.Reset();
+		for (const FPDMissionPoolDefinition& Definition : MissionPools)
+		{
+			CompiledMissionPools.FindOrAdd(Definition.PoolTag).Compile(Definition, MissionTagToMIDLookup);
+		}
+		CompiledMissionPoolsGeneration = DatabaseGeneration;
+	}
+	return CompiledMissionPools.Find(PoolTag);
+}
+
+int32 FPDMissionUtility::DrawMissionsFromPool(const int32 ActorID, const FGameplayTag& PoolTag, const int32 Count, const FRandomStream& Stream, TArray<int32>& OutMIDs)
+{
+	const FPDMissionPool* Pool = FindMissionPool(PoolTag);
+	const UPDMissionTracker* Tracker = GetActorTracker(ActorID);
+	const AActor* TrackerOwner = Tracker != nullptr ? Tracker->GetOwner() : nullptr;
+	if (Pool == nullptr || TrackerOwner == nullptr || Count <= 0) { return 0; }
+
+	// Eligibility filter, the draw itself only samples and rejects against these bits
+	TBitArray<> Eligible(false, Pool->Num());
+	double EligibleWeight = 0.0;
+	for (int32 MemberIdx = 0; MemberIdx < Pool->Num(); MemberIdx++)
+	{
+		const int32 mID = Pool->MemberMIDs[MemberIdx];
+		const FPDMissionNetDatum* Datum = Tracker->GetDatum(mID);
+		if (Datum == nullptr || IsValidMission(mID) == false || Datum->State.Current != EPDMissionState::EInactive) { continue; }
+		if (Pool->EntryConditions[Pool->MemberEntries[MemberIdx]].Evaluate(TrackerOwner) == false) { continue; }
+		if (EvaluateMissionConditions(TrackerOwner, mID) == false) { continue; }
+
+		Eligible[MemberIdx] = true;
+		EligibleWeight += Pool->MemberWeights[MemberIdx];
+	}
+
+	return Pool->Draw(Count, Eligible, EligibleWeight, Stream, OutMIDs);
+}
+
+//
+// PRELOADER
+
+void FPDMissionPreloader::Request(UPDMissionSubsystem* Owner, const int32 mID, const TConstArrayView<TSoftObjectPtr<UObject>> Assets, const int64 InBudgetBytes)
+{
+	BudgetBytes = InBudgetBytes;
+	if (FPreloadEntry* Existing = Entries.Find(mID))
+	{
+		Existing->LastRequest = ++RequestCounter;
+		return;
+	}
+	if (Owner == nullptr || Assets.IsEmpty() || BudgetBytes <= 0 || UAssetManager::IsInitialized() == false) { return; }
+
+	TArray<FSoftObjectPath> AssetPaths;
+	for (const TSoftObjectPtr<UObject>& Asset : Assets)
+	{
+		if (Asset.IsNull() == false) { AssetPaths.Add(Asset.ToSoftObjectPath()); }
+	}
+	if (AssetPaths.IsEmpty()) { return; }
+
+	FPreloadEntry& Entry = Entries.Add(mID);
+	Entry.LastRequest = ++RequestCounter;
+	Entry.Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths,
+		FStreamableDelegate::CreateWeakLambda(Owner, [Owner, mID]() { Owner->Utility.Preloader.OnPreloadFinished(mID); }),
+		FStreamableManager::DefaultAsyncLoadPriority);
+
+	// Already loaded assets may complete before the handle was stored, the delegate would have skipped them
+	if (Entry.Handle.IsValid() && Entry.Handle->HasLoadCompleted()) { OnPreloadFinished(mID); }
+}
+
+void FPDMissionPreloader::OnPreloadFinished(const int32 mID)
+{
+	FPreloadEntry* Entry = Entries.Find(mID);
+	if (Entry == nullptr || Entry->Handle.IsValid() == false || Entry->bMeasured) { return; }
+	Entry->bMeasured = true;
+
+	TArray<UObject*> LoadedAssets;
+	Entry->Handle->GetLoadedAssets(LoadedAssets);
+	for (const UObject* LoadedAsset : LoadedAssets)
+	{
+		if (LoadedAsset != nullptr) { Entry->SizeBytes += LoadedAsset->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal); }
+	}
+	UsedBytes += Entry->SizeBytes;
+	EnforceBudget();
+}
+
+void FPDMissionPreloader::EnforceBudget()
+{
+	while (UsedBytes > BudgetBytes)
+	{
+		// Only loaded preloads count against the budget, in-flight ones are left alone
+		int32 EvictMID = INDEX_NONE;
+		uint64 OldestRequest = MAX_uint64;
+		for (const TPair<int32, FPreloadEntry>& EntryPair : Entries)
+		{
+			if (EntryPair.Value.bMeasured && EntryPair.Value.LastRequest < OldestRequest)
+			{
+				OldestRequest = EntryPair.Value.LastRequest;
+				EvictMID = EntryPair.Key;
+			}
+		}
+		if (EvictMID == INDEX_NONE) { break; }
+
+		FPreloadEntry Evicted;
+		Entries.RemoveAndCopyValue(EvictMID, Evicted);
+		UsedBytes -= Evicted.SizeBytes;
+		if (Evicted.Handle.IsValid()) { Evicted.Handle->ReleaseHandle(); }
+	}
+}
+
+void FPDMissionPreloader::Reset()
+{
+	for (TPair<int32, FPreloadEntry>& EntryPair : Entries)
+	{
+		if (EntryPair.Value.Handle.IsValid() == false) { continue; }
+		
+		if (EntryPair.Value.Handle->IsLoadingInProgress()) { EntryPair.Value.Handle->CancelHandle(); }
+		else { EntryPair.Value.Handle->ReleaseHandle(); }
+	}
+	Entries.Reset();
+	UsedBytes = 0;
+}
+
+void FPDMissionUtility::PreloadBranchTargets(const AActor* Caller, const int32 mID)
+{
+	if (IsRunningDedicatedServer() || IsValidMission(mID) == false || MaxPreloadedBranchesPerMission <= 0) { return; }
+
+	// Branches the caller already meets the conditions of are the most likely ones, then the rest in priority order
+	const int32 NumBranches = GetNumBranches(mID);
+	TArray<int32, TInlineAllocator<8>> LikelyBranches;
+	for (int32 BranchIdx = 0; BranchIdx < NumBranches; BranchIdx++)
+	{
+		if (Caller != nullptr && EvaluateBranchConditions(Caller, mID, BranchIdx)) { LikelyBranches.Add(BranchIdx); }
+	}
+	for (int32 BranchIdx = 0; BranchIdx < NumBranches; BranchIdx++)
+	{
+		LikelyBranches.AddUnique(BranchIdx);
+	}
+
+	const int64 BudgetBytes = static_cast<int64>(PreloadBudgetMegabytes) * 1024 * 1024;
+	const int32 NumPreloads = FMath::Min(LikelyBranches.Num(), MaxPreloadedBranchesPerMission);
+	for (int32 PreloadIdx = 0; PreloadIdx < NumPreloads; PreloadIdx++)
+	{
+		const int32 TargetMID = GetBranchTargetMID(mID, LikelyBranches[PreloadIdx]);
+		if (IsValidMission(TargetMID) == false) { continue; }
+		
+		Preloader.Request(OwningSubsystem, TargetMID, GetPreloadAssets(TargetMID), BudgetBytes);
+	}
+}
+
+const FPDMissionRotationDefinition* FPDMissionUtility::FindMissionRotation(const FGameplayTag& RotationTag) const
+{
+	return MissionRotations.FindByPredicate([&RotationTag](const FPDMissionRotationDefinition& Rotation) { return Rotation.RotationTag == RotationTag; });
+}
+
+int32 FPDMissionUtility::GetMissionRotation(const FGameplayTag& RotationTag, const FDateTime& UtcTime, const int32 Salt, TArray<int32>& OutMIDs)
+{
+	const FPDMissionRotationDefinition* Rotation = FindMissionRotation(RotationTag);
+	const FPDMissionPool* Pool = Rotation != nullptr ? FindMissionPool(Rotation->PoolTag) : nullptr;
+	if (Pool == nullptr) { return 0; }
+
+	const int32 FirstOut = OutMIDs.Num();
+	const int64 PeriodIndex = Rotation->GetPeriodIndex(UtcTime);
+	const FPDMissionRotationKey Key{RotationTag, PeriodIndex, Salt, DatabaseGeneration};
+	if (const TSharedFuture<TArray<int32>>* Precomputed = PrecomputedRotations.Find(Key))
+	{
+		// Blocks if it is still in-flight, which is never slower than starting over
+		OutMIDs.Append(Precomputed->Get());
+		PrecomputedRotations.Remove(Key);
+		return OutMIDs.Num() - FirstOut;
+	}
+
+	Pool->DrawRotation(Rotation->Count, Rotation->MakeRotationSeed(PeriodIndex, Salt), OutMIDs);
+	return OutMIDs.Num() - FirstOut;
+}
+
+bool FPDMissionUtility::PrecomputeMissionRotation(const FGameplayTag& RotationTag, const FDateTime& UtcTime, const int32 Salt)
+{
+	const FPDMissionRotationDefinition* Rotation = FindMissionRotation(RotationTag);
+	const FPDMissionPool* Pool = Rotation != nullptr ? FindMissionPool(Rotation->PoolTag) : nullptr;
+	if (Pool == nullptr) { return false; }
+
+	const int64 PeriodIndex = Rotation->GetPeriodIndex(UtcTime);
+	const FPDMissionRotationKey Key{RotationTag, PeriodIndex, Salt, DatabaseGeneration};
+	if (PrecomputedRotations.Contains(Key)) { return true; }
+
+	// Drop results that can not be requested anymore, an in-flight task keeps its own state alive until it finishes
+	for (auto RotationIt = PrecomputedRotations.CreateIterator(); RotationIt; ++RotationIt)
+	{
+		const FPDMissionRotationKey& OldKey = RotationIt->Key;
+		if (OldKey.Generation != DatabaseGeneration || (OldKey.RotationTag == RotationTag && OldKey.Salt == Salt && OldKey.PeriodIndex < PeriodIndex - 1))
+		{
+			RotationIt.RemoveCurrent();
+		}
+	}
+
+	// The task works on its own copy of the pool, the compiled pools may be rebuilt while it runs
+	PrecomputedRotations.Add(Key, Async(EAsyncExecution::ThreadPool,
+		[PoolCopy = *Pool, Count = Rotation->Count, RotationSeed = Rotation->MakeRotationSeed(PeriodIndex, Salt)]()
+		{
+			TArray<int32> RotationMIDs;
+			PoolCopy.DrawRotation(Count, RotationSeed, RotationMIDs);
+			return RotationMIDs;
+		}).Share());
+	return true;
+}
+
+int32 FPDMissionUtility::CountActorsInState(const int32 mID, const EPDMissionState State) const
+{
+	return MissionStateIndex.Num(mID - 1, State);
+}
+
+void FPDMissionUtility::ForEachActorInState(const int32 mID, const EPDMissionState State, TFunctionRef<void(int32 ActorID)> Func) const
+{
+	const TBitArray<>* SlotSet = MissionStateIndex.Find(mID - 1, State);
+	if (SlotSet == nullptr) { return; }
+
+	for (TConstSetBitIterator<> SlotIt(*SlotSet); SlotIt; ++SlotIt)
+	{
+		Func(ActorIDAllocator.GetActorID(SlotIt.GetIndex()));
+	}
+}
+
 //
 // SETUP
 
-void FPDMissionUtility::InitializeMissionSubsystem()
+void FPDMissionUtility::InitializeMissionSubsystem(UPDMissionSubsystem* InOwningSubsystem)
 {
+	OwningSubsystem = InOwningSubsystem;
 	ProcessTablesForFastLookup();
 	FillIntermediaryMissionList(true); // Overwrite true to clear any straggling data from a previous session
 }
@@ -131,29 +676,73 @@ const TArray<UDataTable*>& FPDMissionUtility::GetAllTables() const
 	return MissionTables;
 }
 
-int32 FPDMissionUtility::RequestNewActorID(int32& LatestCreatedActorID)
+int32 FPDMissionUtility::RequestNewActorID()
 {
-	return ++LatestCreatedActorID;
+	return ActorIDAllocator.Allocate();
 }
 
 void FPDMissionUtility::RegisterUser(UPDMissionTracker* Tracker)
 {
+	if (ActorIDAllocator.IsValid(Tracker->ActorID) == false)
+	{
+		Tracker->ActorID = RequestNewActorID();
+	}
+	
 	const int32 ActorID = Tracker->GetActorID();
+	if (ActorID == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Error, TEXT("FPDMissionUtility::RegisterUser -- Ran out of ActorID slots"));
+		return;
+	}
 
-	MissionTrackerMap.Add(ActorID, Tracker);
+	const int32 Slot = FPDMissionActorIDAllocator::GetSlot(ActorID);
+	if (MissionTrackers.Num() <= Slot)
+	{
+		MissionTrackers.AddZeroed(ActorIDAllocator.NumSlots() - MissionTrackers.Num());
+	}
+	MissionTrackers[Slot] = Tracker;
+
+	// Reuse the allocations of a previous user if there are any pooled
+	if (TrackerStatePool.IsEmpty() == false && Tracker->HasAnyItems() == false)
+	{
+		Tracker->AcquireStateBlock(TrackerStatePool.Pop(false));
+	}
+	
 	if (BoundMissionEvents.Find(ActorID) == nullptr)
 	{
 		BoundMissionEvents.Add(ActorID, {}); // {Event-List} = const FPDMissionTreeMap,
 	}
 
-	InitializeTracker(ActorID); // @todo Load from storage instead of a clean Init, if user data is available 
+	// Re-registered components keep what they already track
+	if (Tracker->HasAnyItems() == false)
+	{
+		InitializeTracker(ActorID); // @todo Load from storage instead of a clean Init, if user data is available 
+	}
 }
 
-void FPDMissionUtility::DeRegisterUser(const UPDMissionTracker* Tracker)
+void FPDMissionUtility::DeRegisterUser(UPDMissionTracker* Tracker)
 {
 	const int32 ActorID = Tracker->GetActorID();
 	if (BoundMissionEvents.Find(ActorID) != nullptr) { BoundMissionEvents.Remove(ActorID); }
 
+	// Only free the slot if it still belongs to this tracker, a stale ID must not release a reused slot
+	if (GetActorTracker(ActorID) == Tracker)
+	{
+		// Needs to happen while the ID is still valid, the slot may go to another actor right after
+		Tracker->ClearStateIndex();
+		ConditionCache.Remove(Tracker->GetOwner());
+		
+		MissionTrackers[FPDMissionActorIDAllocator::GetSlot(ActorID)] = nullptr;
+		ActorIDAllocator.Release(ActorID);
+
+		// Components can be re-registered without being destroyed, their state needs to survive that
+		const bool bTrackerDestroyed = Tracker->IsBeingDestroyed() || Tracker->GetOwner() == nullptr || Tracker->GetOwner()->IsActorBeingDestroyed();
+		if (bTrackerDestroyed && TrackerStatePool.Num() < MaxPooledTrackerStates)
+		{
+			Tracker->ReleaseStateBlock(TrackerStatePool.AddDefaulted_GetRef());
+		}
+	}
+
 	UE_LOG(LogLevel, Log, TEXT("FPDMissionUtility::DeRegisterUser (%i)"), ActorID);
 }
 
@@ -163,69 +752,58 @@ void FPDMissionUtility::ProcessTablesForFastLookup()
 	int32  SuccessCounter  = 0;
 	FString fSuccessCounter = "Succeeded";
 #endif // UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+
+	// mIDs need to be unique across all tables, as they double as the dense index for mission handles
+	int32 MissionID = 0x0;
+	MissionLookup.Reset();
+	MissionTagToMIDLookup.Reset();
+	MissionLookupViaRowName.Reset();
+	MissionRowNameToMIDLookup.Reset();
+	DenseMissionRows.Reset();
+	DenseConditionHandles.Reset();
+	DenseConditionIDs.Reset();
+	ConditionCache.Reset();
+	NextConditionID = 0;
+	Preloader.Reset();
+
+	// Cooked builds fill the lookups from the compiled database when there is one, and skip the tables entirely
+	const bool bUsedCompiledDatabase = ProcessCompiledDatabase(MissionID);
 	
 	for (UDataTable* MissionTable : MissionTables)
 	{
-		if (MissionTable == nullptr) { return; }
-
-		const int32 CurrentID = MissionTable->GetUniqueID();
-		MissionTable->OnDataTableChanged().AddLambda
-		(
-			[&, CurrentID]()
-			{
-				TableRevisions.FindOrAdd(CurrentID)++;
-			}	
-		);
+		if (bUsedCompiledDatabase) { break; }
+		if (MissionTable == nullptr) { continue; } // Keep going, the group merges and the generation bump below still need to happen
 
-		int32 MissionID = 0x0;
-		bool bPackageWasDirtied = false;
-		const TMap<FName, uint8*>& AllItems = MissionTable->GetRowMap();
-
-		if (AllItems.IsEmpty() == false)
-		{
-			MissionTable->MarkPackageDirty();
-		}
-		
-		for (TMap<FName, uint8*>::TConstIterator RowMapIter(AllItems.CreateConstIterator()); RowMapIter; ++RowMapIter)
-		{
-			FPDMissionRow* TableRow = reinterpret_cast<FPDMissionRow*>(RowMapIter.Value());
-			if (TableRow == nullptr) { continue; }
+		const int32 ProcessedRows = ProcessTableForFastLookup(MissionTable, MissionID);
+#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+		SuccessCounter += ProcessedRows;
+#endif // UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
+	}
 
-			bPackageWasDirtied = true;
+	// Streamed groups keep their reserved mID range unless the hard referenced tables have grown into it
+	LatestMissionID = MissionID;
+	for (TPair<FGameplayTag, FPDMissionTableGroupState>& GroupStatePair : TableGroupStates)
+	{
+		FPDMissionTableGroupState& GroupState = GroupStatePair.Value;
+		if (GroupState.FirstMID <= MissionID) { GroupState.FirstMID = INDEX_NONE; continue; }
 
-			// modify the table entry
-			TableRow->Base.mID = ++MissionID;
-			TableRow->Base.ResolveMissionTypeTag();
-			MissionTable->HandleDataTableChanged(RowMapIter.Key());
-			
-			UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.MissionTag: %s"), *TableRow->Base.MissionBaseTag.ToString())
-			UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.MissionCategory: %s"), *TableRow->Base.GetMissionTypeTag().ToString())
-			UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.mID: %i"), TableRow->Base.mID)
-			
-			FDataTableRowHandle RowHandle = UPDMissionStatics::CreateRowHandle(MissionTable, RowMapIter.Key());
-			MissionLookup.Add(TableRow->Base.mID, RowHandle);
-			MissionTagToMIDLookup.Add(TableRow->Base.MissionBaseTag, TableRow->Base.mID);
-			MissionLookupViaRowName.Add(RowHandle.RowName, RowHandle);
+		LatestMissionID = FMath::Max(LatestMissionID, GroupState.FirstMID + GroupState.NumMIDs - 1);
+	}
 
-#if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-			SuccessCounter++;
-#endif // UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
-		}
+	// Merge back in any groups that were already loaded
+	for (TPair<FGameplayTag, FPDMissionTableGroupState>& GroupStatePair : TableGroupStates)
+	{
+		FPDMissionTableGroupState& GroupState = GroupStatePair.Value;
+		if (GroupState.LoadedTables.IsEmpty()) { continue; }
 
-		if (bPackageWasDirtied && MissionTable->MarkPackageDirty() == false)
-		{
-			UE_LOG(LogTemp, Error, TEXT("MissionTable->MarkPackageDirty() failed. in mission subsystem initialize codepath"))
-		}
-		if (bPackageWasDirtied)
-		{
-			MissionTable->PreEditChange(nullptr);
-			MissionTable->PostEditChange();	
-		}
+		MergeTableGroupInternal(GroupState);
 	}
 	
 	// @todo Cycle through the tables a second time to populate some lookups based on mission rules
 	for (UDataTable* MissionTable : MissionTables)
 	{
+		if (bUsedCompiledDatabase) { break; }
+		if (MissionTable == nullptr) { continue; }
 		const TMap<FName, uint8*>& AllItems = MissionTable->GetRowMap();
 
 		for (TMap<FName, uint8*>::TConstIterator RowMapIter(AllItems.CreateConstIterator()); RowMapIter; ++RowMapIter)
@@ -240,13 +818,416 @@ void FPDMissionUtility::ProcessTablesForFastLookup()
 		}
 	}
 
+	ResolveBranchTargets();
+	FPDMissionTagSetPool::Get().SetSharedSets(DenseConditionHandles);
+
+	// Rebuilt lookups, anything resolved against the previous generation is now stale
+	++DatabaseGeneration;
+
 #if UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 	fSuccessCounter = FString{SuccessCounter != 0 ? "Succeeded" : "Failed"} + FString{" at creating mission lookup maps \n"};
 	SuccessCounter = 0;
 #endif // UE_BUILD_DEBUG || UE_BUILD_DEVELOPMENT
 }
 
+int32 FPDMissionUtility::ProcessTableForFastLookup(UDataTable* MissionTable, int32& MissionID)
+{
+	BindMissionTableChanged(MissionTable);
+
+	int32 ProcessedRows = 0;
+	bool bPackageWasDirtied = false;
+	const TMap<FName, uint8*>& AllItems = MissionTable->GetRowMap();
+
+#if WITH_EDITOR
+	if (AllItems.IsEmpty() == false)
+	{
+		MissionTable->MarkPackageDirty();
+	}
+#endif // WITH_EDITOR
+	
+	for (TMap<FName, uint8*>::TConstIterator RowMapIter(AllItems.CreateConstIterator()); RowMapIter; ++RowMapIter)
+	{
+		FPDMissionRow* TableRow = reinterpret_cast<FPDMissionRow*>(RowMapIter.Value());
+		if (TableRow == nullptr) { continue; }
+
+		bPackageWasDirtied = true;
+
+		// modify the table entry
+		TableRow->Base.mID = ++MissionID;
+		TableRow->Base.ResolveMissionTypeTag();
+		MissionTable->HandleDataTableChanged(RowMapIter.Key());
+		
+		UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.MissionTag: %s"), *TableRow->Base.MissionBaseTag.ToString())
+		UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.MissionCategory: %s"), *TableRow->Base.GetMissionTypeTag().ToString())
+		UE_LOG(LogTemp, Warning, TEXT("TableRow->Base.mID: %i"), TableRow->Base.mID)
+		
+		FDataTableRowHandle RowHandle = UPDMissionStatics::CreateRowHandle(MissionTable, RowMapIter.Key());
+		MissionLookup.Add(TableRow->Base.mID, RowHandle);
+		MissionTagToMIDLookup.Add(TableRow->Base.MissionBaseTag, TableRow->Base.mID);
+		MissionLookupViaRowName.Add(RowHandle.RowName, RowHandle);
+		MissionRowNameToMIDLookup.Add(RowHandle.RowName, TableRow->Base.mID);
+		SetDenseMissionRow(TableRow->Base.mID, TableRow);
+
+		ProcessedRows++;
+	}
+
+#if WITH_EDITOR
+	if (bPackageWasDirtied && MissionTable->MarkPackageDirty() == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("MissionTable->MarkPackageDirty() failed. in mission subsystem initialize codepath"))
+	}
+	if (bPackageWasDirtied)
+	{
+		MissionTable->PreEditChange(nullptr);
+		MissionTable->PostEditChange();	
+	}
+#endif // WITH_EDITOR
+	return ProcessedRows;
+}
+
+bool FPDMissionUtility::ProcessCompiledDatabase(int32& MissionID)
+{
+#if WITH_EDITOR
+	// The editor always works on the live tables, they might be newer than the compiled database
+	return false;
+#else
+	LoadedDatabase = CompiledDatabase.LoadSynchronous();
+	LoadedMetadataStore = nullptr;
+	if (LoadedDatabase == nullptr || LoadedDatabase->GetNumRows() == 0) { return false; }
+
+	// Missions are read from the compiled arrays through their mID, only the lookup maps and the per-mission dense data are filled here. The source tables are never loaded nor written to
+	const int32 NumRows = LoadedDatabase->GetNumRows();
+	MissionTagToMIDLookup.Reserve(NumRows);
+	MissionRowNameToMIDLookup.Reserve(NumRows);
+	DenseMissionRows.SetNumZeroed(NumRows);
+	DenseConditionHandles.SetNum(NumRows);
+	DenseConditionIDs.SetNum(NumRows);
+
+	for (int32 mID = 1; mID <= NumRows; mID++)
+	{
+		const FPDCompiledMissionLookup* Lookup = LoadedDatabase->GetLookup(mID);
+		MissionTagToMIDLookup.Add(LoadedDatabase->GetTag(Lookup->TagString), mID);
+		MissionRowNameToMIDLookup.Add(LoadedDatabase->GetName(Lookup->RowNameString), mID);
+
+		// Interned once per mission, every datum created from it shares the handle
+		DenseConditionHandles[mID - 1] = LoadedDatabase->InternConditionTags(LoadedDatabase->GetConditionIndex(mID));
+		DenseConditionIDs[mID - 1] = NextConditionID;
+		NextConditionID += 1 + LoadedDatabase->GetBranches(mID).Num();
+	}
+
+	MissionID = NumRows;
+	return true;
+#endif // WITH_EDITOR
+}
+
+void FPDMissionUtility::SetDenseMissionRow(const int32 mID, FPDMissionRow* MissionRow)
+{
+	const int32 DenseIndex = mID - 1;
+	if (DenseIndex < 0) { return; }
+
+	if (DenseMissionRows.Num() <= DenseIndex)
+	{
+		DenseMissionRows.AddZeroed(DenseIndex + 1 - DenseMissionRows.Num());
+		DenseConditionHandles.SetNum(DenseMissionRows.Num());
+		DenseConditionIDs.SetNum(DenseMissionRows.Num());
+	}
+	DenseMissionRows[DenseIndex] = MissionRow;
+
+	// Compiled alongside the rest of the row processing, so evaluation never has to walk the authored nodes
+	if (MissionRow != nullptr && MissionRow->ProgressRules.CompileConditions() == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("FPDMissionUtility::SetDenseMissionRow -- Malformed condition expression on mID(%i), it will be ignored"), mID);
+	}
+
+	// The mission condition takes the first id, its branches the ones after it
+	if (MissionRow != nullptr)
+	{
+		DenseConditionIDs[DenseIndex] = NextConditionID;
+		NextConditionID += 1 + MissionRow->ProgressRules.NextMissionBranch.Branches.Num();
+	}
+
+	// Interned once per row, every datum created from the row shares the handle
+	DenseConditionHandles[DenseIndex] = MissionRow != nullptr ? FPDMissionTagSetPool::Get().Intern(MissionRow->ProgressRules.MissionConditionHandler) : FPDMissionTagSetHandle{};
+}
+
+void FPDMissionUtility::ResolveBranchTargets()
+{
+	for (FPDMissionRow* MissionRow : DenseMissionRows)
+	{
+		if (MissionRow == nullptr) { continue; }
+
+		for (FPDMissionBranchElement& Branch : MissionRow->ProgressRules.NextMissionBranch.Branches)
+		{
+			// Through the tag lookup, a target in a group that is not merged resolves to INDEX_NONE
+			const FPDMissionRow* TargetRow = Branch.Target.GetRow<FPDMissionRow>("");
+			Branch.TargetMID = TargetRow != nullptr ? ResolveMIDViaTag(TargetRow->Base.MissionBaseTag) : INDEX_NONE;
+		}
+	}
+}
+
+void FPDMissionUtility::BindMissionTableChanged(UDataTable* MissionTable)
+{
+	if (MissionTable == nullptr || OwningSubsystem == nullptr || MissionTableChangedHandles.Contains(MissionTable)) { return; }
+
+	// Bound to the subsystem rather than to this utility, the utility is a copyable property and may not stay at this address
+	const FDelegateHandle Handle = MissionTable->OnDataTableChanged().AddUObject(OwningSubsystem, &UPDMissionSubsystem::OnMissionTableChanged, MissionTable->GetUniqueID());
+	MissionTableChangedHandles.Add(MissionTable, Handle);
+}
+
+void FPDMissionUtility::UnbindMissionTableChanged(UDataTable* MissionTable)
+{
+	FDelegateHandle Handle;
+	if (MissionTable == nullptr || MissionTableChangedHandles.RemoveAndCopyValue(MissionTable, Handle) == false) { return; }
+
+	MissionTable->OnDataTableChanged().Remove(Handle);
+}
+
+void FPDMissionUtility::UnbindAllMissionTablesChanged()
+{
+	for (const TPair<TObjectKey<UDataTable>, FDelegateHandle>& HandlePair : MissionTableChangedHandles)
+	{
+		UDataTable* MissionTable = HandlePair.Key.ResolveObjectPtr();
+		if (MissionTable != nullptr) { MissionTable->OnDataTableChanged().Remove(HandlePair.Value); }
+	}
+	MissionTableChangedHandles.Reset();
+}
+
+void FPDMissionUtility::OnMissionTableChanged(const int32 TableID)
+{
+	TableRevisions.FindOrAdd(TableID)++;
+	++DatabaseGeneration; // Row memory may have moved, any handle resolved before this point is stale
+	ReportDatabaseChecksum();
+}
+
+//
+// STREAMING
+
+const FPDMissionTableGroup* FPDMissionUtility::FindTableGroup(const FGameplayTag& GroupTag) const
+{
+	return MissionTableGroups.FindByPredicate([&GroupTag](const FPDMissionTableGroup& Group) { return Group.GroupTag == GroupTag; });
+}
+
+bool FPDMissionUtility::IsTableGroupLoaded(const FGameplayTag& GroupTag) const
+{
+	const FPDMissionTableGroupState* GroupState = TableGroupStates.Find(GroupTag);
+	return GroupState != nullptr && GroupState->LoadedTables.IsEmpty() == false;
+}
+
+bool FPDMissionUtility::MergeTableGroup(const FGameplayTag& GroupTag, const TArray<UDataTable*>& LoadedTables)
+{
+	if (LoadedTables.IsEmpty()) { return false; }
+
+	FPDMissionTableGroupState& GroupState = TableGroupStates.FindOrAdd(GroupTag);
+	if (GroupState.LoadedTables.IsEmpty() == false)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FPDMissionUtility::MergeTableGroup -- Group(%s) is already merged"), *GroupTag.ToString());
+		return false;
+	}
+	GroupState.LoadedTables = LoadedTables;
+
+	const int32 FirstMID = MergeTableGroupInternal(GroupState);
+	ResolveBranchTargets();
+	FPDMissionTagSetPool::Get().SetSharedSets(DenseConditionHandles);
+
+	// Merging does not move any existing rows, but the dense row cache might have grown so treat it as a rebuild
+	++DatabaseGeneration;
+	FillIntermediaryMissionList(true);
+
+	// Give every registered tracker the default state of the newly merged missions
+	for (const UPDMissionTracker* MissionTracker : MissionTrackers)
+	{
+		if (MissionTracker == nullptr) { continue; }
+		InitializeTrackerRange(MissionTracker->GetActorID(), FirstMID, FirstMID + GroupState.NumMIDs - 1);
+	}
+
+	// Snapshots only elide default runs for clients whose missions match the servers
+	ReportDatabaseChecksum();
+	OnTableGroupChanged.Broadcast(GroupTag, true);
+	return true;
+}
+
+int32 FPDMissionUtility::MergeTableGroupInternal(FPDMissionTableGroupState& GroupState)
+{
+	int32 NumRows = 0;
+	for (const UDataTable* MissionTable : GroupState.LoadedTables)
+	{
+		NumRows += MissionTable != nullptr ? MissionTable->GetRowMap().Num() : 0;
+	}
+
+	// Reuse the previously reserved range when reloading a group, as long as it still fits. Otherwise reserve a new one at the end
+	const bool bCanReuseRange = GroupState.FirstMID != INDEX_NONE && NumRows <= GroupState.NumMIDs;
+	if (bCanReuseRange == false)
+	{
+		GroupState.FirstMID = LatestMissionID + 1;
+		GroupState.NumMIDs = NumRows;
+		LatestMissionID += NumRows;
+	}
+
+	int32 MissionID = GroupState.FirstMID - 1;
+	for (UDataTable* MissionTable : GroupState.LoadedTables)
+	{
+		if (MissionTable == nullptr) { continue; }
+		ProcessTableForFastLookup(MissionTable, MissionID);
+	}
+	return GroupState.FirstMID;
+}
+
+bool FPDMissionUtility::UnmergeTableGroup(const FGameplayTag& GroupTag)
+{
+	FPDMissionTableGroupState* GroupState = TableGroupStates.Find(GroupTag);
+	if (GroupState == nullptr || GroupState->LoadedTables.IsEmpty()) { return false; }
+
+	// Keep the reserved mID range around so a reload of the group resolves to the same mIDs
+	const int32 LastMID = GroupState->FirstMID + GroupState->NumMIDs - 1;
+
+	// Trackers drop the missions of the group, a reload initializes them again from their defaults
+	for (UPDMissionTracker* MissionTracker : MissionTrackers)
+	{
+		if (MissionTracker == nullptr) { continue; }
+		MissionTracker->RemoveMissionRange(GroupState->FirstMID, LastMID);
+	}
+	
+	for (int32 mID = GroupState->FirstMID; mID <= LastMID; mID++)
+	{
+		FDataTableRowHandle RowHandle;
+		if (MissionLookup.RemoveAndCopyValue(mID, RowHandle) == false) { continue; }
+
+		const FPDMissionRow* MissionRow = DenseMissionRows.IsValidIndex(mID - 1) ? DenseMissionRows[mID - 1] : nullptr;
+		if (MissionRow != nullptr) { MissionTagToMIDLookup.Remove(MissionRow->Base.MissionBaseTag); }
+		MissionLookupViaRowName.Remove(RowHandle.RowName);
+		MissionRowNameToMIDLookup.Remove(RowHandle.RowName);
+		SetDenseMissionRow(mID, nullptr);
+	}
+	ResolveBranchTargets();
+	FPDMissionTagSetPool::Get().SetSharedSets(DenseConditionHandles);
+
+	for (UDataTable* MissionTable : GroupState->LoadedTables)
+	{
+		UnbindMissionTableChanged(MissionTable);
+	}
+	GroupState->LoadedTables.Empty();
+	GroupState->StreamingHandle.Reset();
+
+	++DatabaseGeneration;
+	FillIntermediaryMissionList(true);
+
+	ReportDatabaseChecksum();
+	OnTableGroupChanged.Broadcast(GroupTag, false);
+	return true;
+}
+
 void FPDMissionUtility::InitializeTracker(const int32 ActorID)
+{
+	UPDMissionTracker* MissionTracker = GetActorTracker(ActorID);
+	if (MissionTracker == nullptr || MissionTracker->GetOwnerRole() != ROLE_Authority) { return; }
+
+	// Fresh trackers copy the template in one go, trackers that already hold data need their items merged one by one
+	if (MissionTracker->InitializeFromTemplate(GetDefaultDatumTemplate())) { return; }
+	
+	InitializeTrackerRange(ActorID, 1, DenseMissionRows.Num());
+}
+
+FPDMissionNetDatum FPDMissionUtility::MakeDefaultDatum(const int32 mID) const
+{
+	if (IsValidMission(mID) == false) { return FPDMissionNetDatum{mID, FPDMissionState{}}; }
+	
+	return FPDMissionNetDatum{mID, FPDMissionState{GetStartState(mID), DenseConditionHandles[mID - 1]}};
+}
+
+bool FPDMissionUtility::IsDefaultDatum(const FPDMissionNetDatum& Datum) const
+{
+	if (IsValidMission(Datum.mID) == false) { return false; }
+
+	static const FPDMissionTickBehaviour DefaultTickSettings{};
+	return Datum.State.Current == GetStartState(Datum.mID)
+		&& Datum.State.MissionConditionHandle == DenseConditionHandles[Datum.mID - 1]
+		&& Datum.TickSettings.DeltaValue == DefaultTickSettings.DeltaValue
+		&& Datum.TickSettings.Interval == DefaultTickSettings.Interval
+		&& Datum.TickSettings.bIsPaused == DefaultTickSettings.bIsPaused
+		&& Datum.HasDeadline() == false;
+}
+
+uint32 FPDMissionUtility::GetDatabaseChecksum() const
+{
+	if (DatabaseChecksumGeneration == DatabaseGeneration) { return DatabaseChecksum; }
+
+	// Hashed by tag name rather than by tag or handle index, those depend on the process
+	uint32 Checksum = GetTypeHash(DenseMissionRows.Num());
+	for (int32 mID = 1; mID <= DenseMissionRows.Num(); mID++)
+	{
+		const bool bIsValidMission = IsValidMission(mID);
+		Checksum = HashCombine(Checksum, GetTypeHash(bIsValidMission));
+		if (bIsValidMission == false) { continue; }
+
+		Checksum = FCrc::StrCrc32(*GetMissionBaseTag(mID).ToString(), Checksum);
+		Checksum = HashCombine(Checksum, GetTypeHash(static_cast<uint8>(GetStartState(mID))));
+
+		// Tags within a set are ordered by name index, combined order-independently
+		const FPDMissionTagSet& Conditions = DenseConditionHandles[mID - 1].Get();
+		uint32 RequiredChecksum = 0, OptionalChecksum = 0;
+		for (const FGameplayTag& Tag : Conditions.RequiredTags) { RequiredChecksum ^= FCrc::StrCrc32(*Tag.ToString()); }
+		for (const FGameplayTag& Tag : Conditions.OptionalTags) { OptionalChecksum ^= FCrc::StrCrc32(*Tag.ToString()); }
+		Checksum = HashCombine(Checksum, HashCombine(RequiredChecksum, OptionalChecksum));
+	}
+	
+	DatabaseChecksum = Checksum;
+	DatabaseChecksumGeneration = DatabaseGeneration;
+	return DatabaseChecksum;
+}
+
+void FPDMissionUtility::SetConnectionChecksum(const UNetConnection* Connection, const uint32 Checksum)
+{
+	if (Connection == nullptr) { return; }
+
+	// Closed connections are only dropped here, reports are rare enough that this keeps the map small
+	for (auto It = ConnectionChecksums.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ResolveObjectPtr() == nullptr) { It.RemoveCurrent(); }
+	}
+	ConnectionChecksums.Add(FObjectKey(Connection), Checksum);
+}
+
+bool FPDMissionUtility::IsConnectionInSync(const UNetConnection* Connection) const
+{
+	const uint32* Checksum = Connection != nullptr ? ConnectionChecksums.Find(FObjectKey(Connection)) : nullptr;
+	return Checksum != nullptr && *Checksum == GetDatabaseChecksum();
+}
+
+void FPDMissionUtility::ReportDatabaseChecksum() const
+{
+	UPDMissionTracker* MissionTracker = GetLocallyOwnedTracker();
+	if (MissionTracker == nullptr) { return; }
+
+	MissionTracker->ServerReportDatabaseChecksum(GetDatabaseChecksum());
+}
+
+UPDMissionTracker* FPDMissionUtility::GetLocallyOwnedTracker() const
+{
+	for (UPDMissionTracker* MissionTracker : MissionTrackers)
+	{
+		const AActor* TrackerOwner = MissionTracker != nullptr ? MissionTracker->GetOwner() : nullptr;
+		if (TrackerOwner == nullptr || TrackerOwner->HasAuthority() || TrackerOwner->GetNetConnection() == nullptr) { continue; }
+		return MissionTracker;
+	}
+	return nullptr;
+}
+
+const TArray<FPDMissionNetDatum>& FPDMissionUtility::GetDefaultDatumTemplate()
+{
+	if (DefaultDatumTemplateGeneration == DatabaseGeneration) { return DefaultDatumTemplate; }
+
+	DefaultDatumTemplate.Reset(DenseMissionRows.Num());
+	for (int32 mID = 1; mID <= DenseMissionRows.Num(); mID++)
+	{
+		if (IsValidMission(mID) == false) { continue; }
+		
+		DefaultDatumTemplate.Add(MakeDefaultDatum(mID));
+	}
+	DefaultDatumTemplateGeneration = DatabaseGeneration;
+	return DefaultDatumTemplate;
+}
+
+void FPDMissionUtility::InitializeTrackerRange(const int32 ActorID, const int32 FirstMID, const int32 LastMID)
 {
 	UPDMissionTracker* MissionTracker = GetActorTracker(ActorID);
 	if (MissionTracker == nullptr || MissionTracker->GetOwnerRole() != ROLE_Authority)
@@ -254,13 +1235,11 @@ void FPDMissionUtility::InitializeTracker(const int32 ActorID)
 		return;
 	};
 
-	for (TTuple<int32, FDataTableRowHandle>& BaseMission : MissionLookup)
+	for (int32 mID = FMath::Max(FirstMID, 1); mID <= FMath::Min(LastMID, DenseMissionRows.Num()); mID++)
 	{
-		const FPDMissionRow* DefaulMission = BaseMission.Value.GetRow<FPDMissionRow>(TEXT(""));
-		if (DefaulMission == nullptr) { continue; }
+		if (IsValidMission(mID) == false || MissionTracker->ShouldTrackMission(mID) == false) { continue; }
 		
-		FPDMissionNetDatum Mission{DefaulMission->Base.mID, FPDMissionState{DefaulMission->ProgressRules.EStartState, DefaulMission->ProgressRules.MissionConditionHandler}};
-		MissionTracker->AddMissionDatum(Mission);
+		MissionTracker->AddMissionDatum(MakeDefaultDatum(mID));
 	}
 }
 
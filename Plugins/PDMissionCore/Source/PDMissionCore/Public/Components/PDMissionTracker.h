@@ -3,9 +3,84 @@
 
 #include "PDMissionCommon.h"
 #include "Net/MissionDatum.h"
+#include "Data/PDMissionStateMachine.h"
 #include "PDMissionTracker.generated.h"
 
 
+/**
+ * @brief Delayed transition waiting for its deadline
+ */
+struct PDMISSIONCORE_API FPDMissionDeadlineEntry
+{
+	/** @brief Server world time the transition is due at */
+	double Deadline = 0.0;
+	FGameplayTag MissionBaseTag;
+	FPDMissionNetDatum OverwriteDatum;
+	FPDMissionBranchBehaviour BranchBehaviour;
+
+	/** @brief Orders the deadline heap, earliest first */
+	bool operator<(const FPDMissionDeadlineEntry& Other) const { return Deadline < Other.Deadline; }
+};
+
+/**
+ * @brief Transition staged in an open transaction, folded through the transition matrix when the transaction commits
+ */
+struct PDMISSIONCORE_API FPDMissionStagedEvent
+{
+	int32 mID = INDEX_NONE;
+	/** @brief EINVALID_EVENT for raw state writes, those are resolved to the single event that reaches 'TargetState' once the events staged before it are folded */
+	EPDMissionEvent Event = EINVALID_EVENT;
+	EPDMissionState TargetState = EPDMissionState::EINVALID_STATE;
+	/** @brief Server world time of the deadline or cooldown expiry, for the events that set one */
+	double DeadlineSeconds = 0.0;
+};
+
+/**
+ * @brief Changes staged between UPDMissionTracker::BeginMissionTransaction and CommitMissionTransaction
+ */
+struct PDMISSIONCORE_API FPDMissionTransaction
+{
+	/** @brief Staged transitions in staging order, any number per mID */
+	TArray<FPDMissionStagedEvent> StagedEvents;
+
+	/** @brief Delayed transitions scheduled while the transaction is open, only scheduled once it commits */
+	TArray<FPDMissionDeadlineEntry> StagedDeadlines;
+	
+	bool bIsOpen = false;
+};
+
+/**
+ * @brief Cooldown of a finished repeatable mission, kept compact as there may be dozens of them per actor
+ */
+struct PDMISSIONCORE_API FPDMissionCooldownEntry
+{
+	/** @brief Server world time the cooldown expires at, in tenths of a second. Same encoding as FPDMissionNetDatum::DeadlineTenths */
+	uint32 ExpiryTenths = 0;
+	int32 mID = INDEX_NONE;
+
+	/** @brief Orders the cooldown heap, earliest first */
+	bool operator<(const FPDMissionCooldownEntry& Other) const { return ExpiryTenths < Other.ExpiryTenths; }
+};
+
+/**
+ * @brief One page of a trackers missions, holds all missions sharing a mission type tag.
+ * @note Replicated as a subobject of its tracker, each page is its own fast-array with its own dirty tracking
+ */
+UCLASS()
+class PDMISSIONCORE_API UPDMissionTrackerPage : public UObject
+{
+	GENERATED_BODY()
+public:
+	virtual bool IsSupportedForNetworking() const override { return true; }
+	/** @brief Sets the owner of the page state to the outer tracker */
+	virtual void PostInitProperties() override;
+
+	/** @brief Mission type tag shared by all missions in this page */
+	UPROPERTY(Replicated) FGameplayTag PageTag;
+	/** @brief Replicated missions of this page */
+	UPROPERTY(Replicated) FPDMissionNetDataCompound State;
+};
+
 /**
  * @brief Tracks public and private progress
  */
@@ -14,17 +89,77 @@ class PDMISSIONCORE_API UPDMissionTracker : public UActorComponent
 {
 	GENERATED_BODY()
 public:
+	UPDMissionTracker(const FObjectInitializer& ObjectInitializer);
+	
 	FORCEINLINE int32 GetActorID() const { return ActorID; }
+
+	/** @brief Flushes the changes staged while coalescing, ticks at the end of the frame only while there is something staged */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/** @brief Registers the tracker with the mission subsystem, only in game worlds */
+	virtual void OnRegister() override;
+	/** @brief Deregisters the tracker from the mission subsystem, clears its registry slot before it can be collected */
+	virtual void OnUnregister() override;
+	/** @brief Reports the clients database checksum if this client owns the tracker, see FPDMissionUtility::IsConnectionInSync */
+	virtual void BeginPlay() override;
 	
-	/** @brief Sets the value of the replicated datum with the value of the parameter OverrideDatum. Will clamp it based on limits */
+	/**
+	 * @brief Applies 'Event' to the mission through the transition matrix, along with its side effects. See FPDMissionStateMachine::Apply
+	 * @param DeadlineSeconds Server world time of the deadline or cooldown expiry, for the events that set one
+	 * @return true if the transition was applied, or staged into the open transaction. A staged transition may still be discarded by an abort or a failed commit
+	 */
+	bool TransitionMission(const FGameplayTag& BaseTag, EPDMissionEvent Event, double DeadlineSeconds = 0.0);
+
+	/**
+	 * @brief Moves the mission to the state of 'OverrideDatum', as the single matrix event that goes there. Its deadline is passed along with the event
+	 * @note Only states one transition away are accepted, see FPDMissionStateMachine::ValidateStep. Writes that keep the current state are rejected, prefer TransitionMission
+	 * @return true if the change was applied, or staged into the open transaction. A staged change may still be discarded by an abort or a failed commit
+	 */
 	UFUNCTION(BlueprintCallable)
 	bool SetMissionDatum(const FGameplayTag& BaseTag, const FPDMissionNetDatum& OverrideDatum);
 
-	/** @brief Called when finalizing a overwrite from FinishMission(), used for immediate transition */
-	void FinalizeOverwriteRef(const FGameplayTag& MissionBaseTag, FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour);
+	/** @brief Opens a transaction, any TransitionMission and SetMissionDatum calls until commit or abort are staged instead of applied. @return false if one is already open or not on the server */
+	UFUNCTION(BlueprintCallable)
+	bool BeginMissionTransaction();
+
+	/** @brief Stages a raw state write in the open transaction, applied as the single event that reaches the state of 'Datum' from the state the earlier staged changes leave the mission in */
+	UFUNCTION(BlueprintCallable)
+	bool StageMissionDatum(const FGameplayTag& BaseTag, const FPDMissionNetDatum& Datum);
+
+	/**
+	 * @brief Validates all staged changes, then applies them together as a single coalesced update, and schedules the staged delayed transitions.
+	 *        Each missions staged events are folded in order through FPDMissionStateMachine::Apply on a copy of its current datum, every step needs to be legal.
+	 *        Completions also need the owner to meet the missions conditions and condition expression
+	 * @return false, and nothing applied nor scheduled, if any change fails validation
+	 */
+	UFUNCTION(BlueprintCallable)
+	bool CommitMissionTransaction();
+
+	/** @brief Discards all staged changes and staged delayed transitions, and closes the transaction */
+	UFUNCTION(BlueprintCallable)
+	void AbortMissionTransaction();
+
+	/** @brief Is there an open transaction */
+	FORCEINLINE bool IsInMissionTransaction() const { return Transaction.bIsOpen; }
+
+	/** @brief Called when finalizing a overwrite from FinishMission(), used for immediate transition. Applies the branch event to the tracked mission. @return false if the transition was illegal */
+	bool FinalizeOverwriteRef(const FGameplayTag& MissionBaseTag, FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour);
 	
 	/** @brief Called when finalizing a overwrite from FinishMission(), used for delayed transition*/
 	void FinalizeOverwriteCopy(FGameplayTag MissionBaseTag, FPDMissionNetDatum OverwriteDatum, FPDMissionBranchBehaviour BranchBehaviour); 
+
+	/** @brief Schedules a delayed transition at server world time 'Deadline'. All of a trackers deadlines share a single timer, armed for the earliest one. Staged while a transaction is open */
+	void ScheduleMissionDeadline(const FGameplayTag& MissionBaseTag, const FPDMissionNetDatum& OverwriteDatum, const FPDMissionBranchBehaviour& BranchBehaviour, double Deadline);
+
+	/**
+	 * @brief Starts the cooldown of a finished repeatable mission, it is reset to inactive once 'ExpirySeconds' has passed.
+	 * @note Shares the deadline timer. The expiry is also written to the datums deadline so clients can show the remaining cooldown
+	 */
+	void ScheduleMissionCooldown(int32 mID, double ExpirySeconds);
+
+	/** @brief Seconds left until the missions deadline, computed locally from the synchronized server time. @return -1 if the mission has no deadline */
+	UFUNCTION(BlueprintCallable)
+	float GetMissionTimeRemaining(const FGameplayTag& BaseTag) const;
 	
 	/** @brief Gets the value of the replicated datum  */
 	UFUNCTION(BlueprintCallable)
@@ -34,15 +169,174 @@ public:
 	const FPDMissionNetDatum* GetDatum(int32 SID) const;
 	/** @brief  Gets the replicated datum from it's tag */
 	const FPDMissionNetDatum* GetDatum(const FGameplayTag& BaseTag) const;
+	/** @brief  Gets the replicated datum from a resolved handle. O(1) as long as the trackers handle lookup is current. nullptr if the handle is of an older database generation */
+	const FPDMissionNetDatum* GetDatum(const FPDMissionHandle& Handle) const;
+
+	/** @brief Gets the value of the replicated datum via a resolved handle */
+	UFUNCTION(BlueprintCallable)
+	TEnumAsByte<EPDMissionState> GetStateSelectorViaHandle(const FPDMissionHandle& Handle) const;
 	
-	/** @brief  Get all the tracked mission data */
-	TArray<FPDMissionNetDatum>& GetUserMissions();
+	/** @brief  Get a copy of all the tracked mission data, gathered from the root 'State' and every page */
+	TArray<FPDMissionNetDatum> GetUserMissions() const;
 	
 	/** @brief Adds and tracks new mission data */
 	bool AddMissionDatum(const FPDMissionNetDatum& Mission);
 
+	/** @brief Stops tracking the missions in range [FirstMID, LastMID], i.e. when their table group is unloaded. Server only */
+	void RemoveMissionRange(int32 FirstMID, int32 LastMID);
+
 	/** @brief  Function that resolves to dispatching the OnUpdated delegate if possible*/
 	void OnDatumUpdated(const FPDMissionNetDatum* CallingStat) const;
+
+	/** @brief  Marks the handle lookup as stale, it gets rebuilt on the next handle query */
+	FORCEINLINE void InvalidateHandleLookup() { HandleGeneration = INDEX_NONE; }
+
+	/** @brief  Fills the tracked items from a prebuilt list of default datums in a single pass. @return false if the tracker already tracks missions */
+	bool InitializeFromTemplate(const TArray<FPDMissionNetDatum>& Template);
+
+	/** @brief  Empties the tracked state and moves its allocations into 'OutBlock' */
+	void ReleaseStateBlock(FPDMissionTrackerStateBlock& OutBlock);
+
+	/** @brief  Takes over the allocations of a pooled block, recreating the pages the block holds allocations for. Ignored if the tracker already tracks missions */
+	void AcquireStateBlock(FPDMissionTrackerStateBlock&& Block);
+
+	/**
+	 * @brief  Applies all staged dirty marks and broadcasts right away, instead of waiting for the end of the frame
+	 * @note Changes staged by listeners while flushing are flushed in the same call
+	 */
+	void FlushPendingChanges();
+
+	/** @brief  Focuses or unfocuses a mission, focused missions always replicate right away. Meant for missions pinned in the quest log or tied to the current region, server only */
+	UFUNCTION(BlueprintCallable)
+	void SetMissionFocus(const FGameplayTag& BaseTag, bool bFocused);
+
+	/** @brief  Lets the owning client pin or unpin missions */
+	UFUNCTION(Server, Reliable, BlueprintCallable)
+	void ServerSetMissionFocus(FGameplayTag BaseTag, bool bFocused);
+
+	/** @brief  Is the mission focused */
+	bool IsMissionFocused(int32 mID) const;
+
+	/**
+	 * @brief  Asks the server to resend every item as a regular delta, used when a snapshot could not be rebuilt locally
+	 * @note   Sent through any tracker the client owns, so trackers of other players and group trackers can be requested as well
+	 */
+	void RequestFullState();
+
+	/** @brief  Resends every item of 'TargetTracker' on behalf of the requesting client, see ScheduleFullState */
+	UFUNCTION(Server, Reliable)
+	void ServerRequestFullState(UPDMissionTracker* TargetTracker);
+
+	/** @brief  Stores the database checksum of the owning connection, snapshots are only sent to connections whose checksum matches the servers */
+	UFUNCTION(Server, Reliable)
+	void ServerReportDatabaseChecksum(uint32 Checksum);
+
+	/** @brief  Resends every item, at most once per 'FullStateResendInterval'. Requests made while a resend is waiting are served by it. Server only */
+	void ScheduleFullState();
+
+	/** @brief  Are there background changes waiting for bandwidth budget */
+	bool HasThrottledChanges() const;
+
+	/**
+	 * @brief  Joins or leaves a group, shared missions are read from and written to the group tracker while joined. Server only
+	 * @note   Joining hands local progress of shared missions to the group, unless the group has already progressed them. Leaving keeps a copy of the group progress
+	 */
+	void SetGroupTracker(UPDMissionTracker* NewGroupTracker);
+
+	/** @brief  Sets the tags of the missions a group tracker stores. Set before members join, missions already tracked are not moved. Server only */
+	void SetSharedMissionTags(const TArray<FGameplayTag>& NewSharedMissionTags);
+
+	/** @brief  Is the mission shared through a group tracker. Matches 'SharedMissionTags' of the group tracker, always false while not joined to a group */
+	bool IsSharedMission(int32 mID) const;
+
+	/** @brief  Should this tracker store the mission itself. Group trackers store only shared missions, all other trackers store every mission that is not currently shared */
+	bool ShouldTrackMission(int32 mID) const;
+
+	/** @brief  The tracker that stores the mission, the group tracker for shared missions while joined to a group, otherwise this */
+	UPDMissionTracker* ResolveOwningTracker(int32 mID);
+
+	/** @brief  Removes all of this trackers missions from the subsystems state index */
+	void ClearStateIndex();
+
+	/** @brief  Does the tracker track any missions, in the root state or in any page */
+	bool HasAnyItems() const;
+
+	/** @brief  Gets the compound of a page, INDEX_NONE or an invalid page index is the root 'State' */
+	FPDMissionNetDataCompound& GetCompound(int32 PageIndex);
+	const FPDMissionNetDataCompound& GetCompound(int32 PageIndex) const;
+
+protected:
+	/** @brief  Rebuilds the dense handle lookup from the tracked items */
+	void RebuildHandleLookup(int32 Generation) const;
+
+	/** @brief  Rebuilds the dense handle lookup against the current database generation, if it has been invalidated */
+	void EnsureHandleLookup() const;
+
+	/** @brief  Grows the dense handle and page lookups to hold at least 'Num' missions */
+	void GrowDenseLookups(int32 Num) const;
+
+	/** @brief  Writes the page and item index of a newly added item into the dense handle lookup, if the lookup is current */
+	void UpdateHandleLookup(int32 mID, int32 PageIndex, int32 ItemIndex);
+
+	/** @brief  Finds the item index of 'mID' and the page it is in, through the dense handle lookup. @return INDEX_NONE if not tracked */
+	int32 FindItemIndex(int32 mID, int32& OutPageIndex) const;
+	/** @brief  Finds the tracked datum of 'mID' in whichever page it is in */
+	const FPDMissionNetDatum* FindDatum(int32 mID) const;
+	/** @brief  Gets the page 'mID' belongs to, creating the page if needed. Always the root 'State' if 'bPageByMissionType' is not set */
+	int32 ResolvePageIndex(int32 mID);
+	/** @brief  Gets the index of the page holding missions of type 'PageTag', creating and registering the page if needed. Server only */
+	int32 FindOrAddPage(const FGameplayTag& PageTag);
+	/** @brief  Pages that arrive after their items were added are not in the handle lookup yet, invalidates it */
+	UFUNCTION()
+	void OnRep_Pages();
+	/** @brief  Invalidates the shared mission mask */
+	UFUNCTION()
+	void OnRep_SharedMissionTags();
+	/** @brief  Copies the shared missions 'SourceTracker' stores into this tracker, as new items. Server only */
+	void CopySharedMissionsFrom(const UPDMissionTracker& SourceTracker);
+	/** @brief  Hands this trackers copies of shared missions over to 'TargetTracker' and stops tracking them locally. Server only */
+	void HandOverSharedMissionsTo(UPDMissionTracker& TargetTracker);
+	/** @brief  Marks the compound of a page dirty for push-model replication */
+	void MarkCompoundDirty(int32 PageIndex);
+
+	/** @brief  Finalizes every scheduled transition that is due, then re-arms the timer for the next one */
+	void OnDeadlineReached();
+	/** @brief  Arms the deadline timer for the earliest scheduled deadline or cooldown */
+	void ArmDeadlineTimer();
+	/** @brief  Server world time of the earliest scheduled deadline or cooldown. @return -1 if nothing is scheduled */
+	double GetEarliestDeadline() const;
+	/** @brief  Resets the mission if it is still finished and still on the cooldown of 'Entry', the cooldown may have been superseded since */
+	void ExpireMissionCooldown(const FPDMissionCooldownEntry& Entry);
+
+	/** @brief  Moves the mission to 'NewState' in the subsystems state index, if it is not already indexed under it */
+	void UpdateStateIndex(int32 mID, EPDMissionState NewState);
+
+	/** @brief  Preloads the assets of the likely next missions once a mission becomes active. Only for locally owned trackers */
+	void PreloadUpcomingMissions(int32 mID, EPDMissionState NewState) const;
+
+	/** @brief  Should changes to the mission wait for background budget before replicating. Never without push-model replication */
+	bool ShouldThrottle(int32 mID) const;
+	/** @brief  Queues a background mission for replication, the item itself is already marked dirty */
+	void ThrottleItemChange(int32 mID);
+	/** @brief  Replicates queued background missions in order, for as long as the budget allows */
+	void DrainThrottledChanges();
+
+	/** @brief  Writes 'OverrideDatum' into the tracked item of 'mID', adding it if not tracked yet. Unchecked, callers validate the state change or carry over existing state as-is */
+	void ApplyMissionDatum(int32 mID, const FPDMissionNetDatum& OverrideDatum);
+	/** @brief  Copy of the tracked datum of 'mID', or of the missions default if not tracked yet. Staged changes are not included */
+	FPDMissionNetDatum CopyCurrentDatum(int32 mID) const;
+
+	/** @brief  Single funnel for item changes. Marks the item and property dirty and broadcasts right away, or stages it if 'bCoalesceUpdates' is set */
+	void CommitItemChange(int32 mID, int32 PageIndex, int32 ItemIndex, bool bItemAdded, bool bBroadcast);
+	
+	/** @brief  Flags of a staged item change */
+	enum EPDPendingItemFlags : uint8
+	{
+		EPendingItem_None      = 0,
+		EPendingItem_Staged    = 1 << 0,
+		EPendingItem_MarkDirty = 1 << 1,
+		EPendingItem_Broadcast = 1 << 2,
+	};
 public:
 	
 	/**<@brief List of tags of stats to be shared with all clients */
@@ -63,10 +357,85 @@ public:
 	/** @brief  Non-replicated data, exists only on the server */
 	UPROPERTY()           FPDMissionNetDataCompound HiddenMissionState;                
 
+	/** @brief When set, missions are split into pages by their mission type tag, a change only dirties the page it is in. Otherwise everything lives in 'State' */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) bool bPageByMissionType = false;
+	/** @brief Mission pages, replicated as subobjects */
+	UPROPERTY(ReplicatedUsing = OnRep_Pages) TArray<UPDMissionTrackerPage*> Pages;
+	/** @brief Page index per mission type tag, server only */
+	TMap<FGameplayTag, int32> PageIndexByTag;
+	/** @brief Page index per dense mission index, INDEX_NONE for missions in the root 'State'. Rebuilt with the handle lookup */
+	mutable TArray<int16> DensePageIndices;
+
+	/** @brief When set the tracker stores missions matching 'SharedMissionTags' on behalf of a group, and nothing else */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) bool bIsGroupTracker = false;
+	/** @brief Tags of the missions a group tracker stores on behalf of its members. Unused on member trackers, they follow the tags of their group tracker */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_SharedMissionTags) TArray<FGameplayTag> SharedMissionTags;
+	/** @brief Group tracker owning this trackers shared missions, if joined to a group */
+	UPROPERTY(Replicated, BlueprintReadOnly) UPDMissionTracker* GroupTracker = nullptr;
+	/** @brief Shared flag per dense mission index, built from 'SharedMissionTags'. Group trackers only */
+	mutable TBitArray<> SharedMissionMask;
+	/** @brief Database generation the shared mask was built against */
+	mutable int32 SharedMissionMaskGeneration = INDEX_NONE;
+
+	/** @brief State each mission is indexed under in the subsystems state index, per dense mission index. EINVALID_STATE if not indexed. Server only */
+	TArray<uint8> IndexedStates;
+
 	/** @brief Generated ID of owning actor */
 	int32 ActorID = INDEX_NONE;                    
 	/** @brief Map to associate an SID to its replication id in the fast-array */
 	UPROPERTY() TMap<int32, int32> mIDToReplIdMap; 
+	/** @brief Dense handle lookup, maps a handles dense index to an item index in its page. Rebuilt lazily */
+	mutable TArray<int32> DenseItemIndices;
+	/** @brief Database generation the dense handle lookup was built against */
+	mutable int32 HandleGeneration = INDEX_NONE;
+
+	/** @brief When set, item changes are staged and flushed once at the end of the frame. Repeated changes to the same item within a frame result in one dirty mark and one broadcast */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) bool bCoalesceUpdates = false;
+	/** @brief mIDs with staged changes, in the order they were first staged */
+	TArray<int32> PendingMIDs;
+	/** @brief EPDPendingItemFlags per dense mission index, sized lazily */
+	TArray<uint8> PendingItemFlags;
+	/**
+	 * @brief When set, changes to missions that are not focused are rate-limited by the background budget. Focused missions always replicate right away
+	 * @note Only applies with push-model replication enabled, without it the compounds are compared every net update and nothing can be held back
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite) bool bThrottleBackgroundMissions = false;
+	/** @brief Background replication budget, refilled continuously */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bThrottleBackgroundMissions", ClampMin = "1")) int32 BackgroundBytesPerSecond = 512;
+	/** @brief Most budget that can build up while idle. Never less than 'BackgroundBytesPerUpdate', the queue could not drain otherwise */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bThrottleBackgroundMissions", ClampMin = "1")) int32 BackgroundBurstBytes = 256;
+	/** @brief Estimated cost of replicating one changed mission */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bThrottleBackgroundMissions", ClampMin = "1")) int32 BackgroundBytesPerUpdate = 16;
+	/** @brief Focused flag per dense mission index, server only */
+	TBitArray<> FocusedMissions;
+	/** @brief Background mIDs waiting for budget, in the order they were queued. Consumed from 'ThrottledHead' */
+	TArray<int32> ThrottledMIDs;
+	int32 ThrottledHead = 0;
+	/** @brief Queued flag per dense mission index, cleared when sent early because the mission gained focus */
+	TBitArray<> ThrottledQueued;
+	/** @brief Current background budget, in bytes */
+	double ThrottleBudgetBytes = 0.0;
+	/** @brief World time of the last budget refill */
+	double LastThrottleRefillTime = 0.0;
+	
+	/** @brief Scheduled delayed transitions, min-heap on deadline. Server only */
+	TArray<FPDMissionDeadlineEntry> DeadlineHeap;
+	/** @brief Cooldowns of finished repeatable missions, min-heap on expiry. Server only */
+	TArray<FPDMissionCooldownEntry> CooldownHeap;
+	/** @brief Single timer shared by all scheduled deadlines and cooldowns */
+	FTimerHandle DeadlineTimerHandle;
+
+	/** @brief Minimum time between two full resends, the resend reaches every connection. Server only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0")) float FullStateResendInterval = 1.0f;
+	/** @brief World time of the last full resend */
+	double LastFullStateResendTime = -1.0;
+	/** @brief Pending full resend, set while waiting for 'FullStateResendInterval' to pass */
+	FTimerHandle FullStateTimerHandle;
+	/** @brief Marks every item dirty so all connections receive it again */
+	void ResendFullState();
+	
+	/** @brief Currently open transaction, if any */
+	FPDMissionTransaction Transaction;
 
 	// Delegate bindings
 	/** @brief Broadcasts an event any time a mission updates */
@@ -75,6 +444,8 @@ public:
 	UPROPERTY(BlueprintAssignable) FPDTickMission    OnMissionTick;
 	/** @brief Broadcasts an event when a mission updates, runs only on server */
 	UPROPERTY(BlueprintAssignable) FPDUpdateMission  Server_OnMissionUpdated; 
+	/** @brief Broadcasts once per flush with all missions that changed since the last flush, only used with 'bCoalesceUpdates', runs only on server */
+	UPROPERTY(BlueprintAssignable) FPDUpdateMissionBatch Server_OnMissionsUpdatedBatch; 
 };
 
 
@@ -0,0 +1,192 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+#include "PDMissionCondition.generated.h"
+
+UENUM()
+enum EPDMissionConditionOp
+{
+	EConditionAnd,         // True if all of the next 'NumChildren' expressions are true
+	EConditionOr,          // True if any of the next 'NumChildren' expressions is true
+	EConditionNot,         // Negates the next expression
+	EConditionHasTag,      // Actor has 'Tag' or any child tag of it
+	EConditionHasTagExact, // Actor has exactly 'Tag'
+	EConditionCounter,     // Compares the number of actor tags matching 'Tag' against 'Value'
+};
+
+UENUM()
+enum EPDMissionConditionCompare
+{
+	ECompareEqual,
+	ECompareNotEqual,
+	ECompareLess,
+	ECompareLessOrEqual,
+	ECompareGreater,
+	ECompareGreaterOrEqual,
+};
+
+/**
+ * @brief One node of an authored condition expression. Expressions are flat lists in prefix order, an operator is followed by its operands
+ * @note Example, HasTag(A) AND (HasTag(B) OR NOT HasTag(C)): [And(2), HasTag(A), Or(2), HasTag(B), Not, HasTag(C)]
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionConditionNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Condition")
+	TEnumAsByte<EPDMissionConditionOp> Op = EPDMissionConditionOp::EConditionHasTag;
+
+	/** @brief Number of operands of an And/Or node */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Condition", Meta = (ClampMin = 1))
+	int32 NumChildren = 2;
+
+	/** @brief Tag to test for the tag and counter nodes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Condition")
+	FGameplayTag Tag;
+
+	/** @brief Comparison of a counter node, the count is on the left-hand side */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Condition")
+	TEnumAsByte<EPDMissionConditionCompare> Compare = EPDMissionConditionCompare::ECompareGreaterOrEqual;
+
+	/** @brief Right-hand side of a counter node */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Condition")
+	int32 Value = 1;
+};
+
+/**
+ * @brief Single instruction of a compiled condition program
+ * @note Plain data, the compiled mission database stores the programs of all its conditions back to back
+ */
+struct PDMISSIONCORE_API FPDMissionConditionInstr
+{
+	uint8 Op = 0;
+	uint8 Compare = 0;
+	/** @brief Operand count for And/Or, tag index for the tag and counter ops */
+	uint16 Operand = 0;
+	int32 Value = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FPDMissionConditionInstr& Instr);
+};
+
+/**
+ * @brief Condition expression compiled to postfix bytecode. Evaluated on a fixed size stack, so evaluation never allocates
+ * @note Compiled once when the mission tables are processed, or when cooking the compiled mission database
+ */
+struct PDMISSIONCORE_API FPDMissionConditionProgram
+{
+	static constexpr int32 MaxStackDepth = 32;
+
+	/** @brief Compiles 'Nodes' into 'OutProgram'. @return false, and an empty program, if the expression is malformed or too deep */
+	static bool Compile(const TArray<FPDMissionConditionNode>& Nodes, FPDMissionConditionProgram& OutProgram);
+
+	/**
+	 * @brief Evaluates the program against 'ActorTags'. An empty program always passes
+	 * @param ExpandedTags 'ActorTags' including all parent tags, see IPDMissionInterface::GetExpandedTagContainer
+	 */
+	bool Evaluate(const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags) const;
+
+	/** @brief Evaluates 'ProgramCode' with tag table 'ProgramTags' against 'ActorTags', for programs stored outside of a FPDMissionConditionProgram. An empty program always passes */
+	static bool Evaluate(TConstArrayView<FPDMissionConditionInstr> ProgramCode, TConstArrayView<FGameplayTag> ProgramTags, const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags);
+	
+	/** @brief Evaluates the program against the tags of 'Caller'. Fails if the caller does not implement the mission interface, unless the program is empty */
+	bool Evaluate(const AActor* Caller) const;
+
+	FORCEINLINE bool IsEmpty() const { return Code.IsEmpty(); }
+	
+	TArray<FPDMissionConditionInstr> Code;
+	TArray<FGameplayTag> Tags;
+};
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
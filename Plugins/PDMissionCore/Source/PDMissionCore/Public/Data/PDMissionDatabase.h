@@ -0,0 +1,315 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDMissionCommon.h"
+#include <Engine/DataAsset.h>
+
+#include "PDMissionDatabase.generated.h"
+
+/**
+ * @brief Compiled condition. Tags are stored as string-table indices in 'ConditionTags', required tags first, then the optional tags, then the tag table of the expression.
+ *        The condition expression is stored as a contiguous range of 'ConditionCode', already compiled to a FPDMissionConditionProgram, its tag operands index the expressions tag table
+ * @note Plain data, no pointers, only offsets into the other compiled arrays
+ */
+struct PDMISSIONCORE_API FPDCompiledMissionCondition
+{
+	int32 FirstTag = 0;
+	int32 NumRequiredTags = 0;
+	int32 NumOptionalTags = 0;
+	int32 NumExpressionTags = 0;
+	int32 FirstInstr = 0;
+	int32 NumInstrs = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FPDCompiledMissionCondition& Condition);
+};
+
+/**
+ * @brief Compiled branch element, 'TargetMID' is resolved at compile time
+ * @note Plain data, no pointers, only offsets into the other compiled arrays
+ */
+struct PDMISSIONCORE_API FPDCompiledMissionBranch
+{
+	int32 TargetMID = INDEX_NONE;
+	int32 Condition = INDEX_NONE;
+	float DelayTime = 0.0f;
+	uint8 Type = EPDMissionBranchBehaviour::ETrigger;
+	uint8 bIsDirectBranch = 0;
+	uint8 Padding[2] = {0, 0};
+
+	friend FArchive& operator<<(FArchive& Ar, FPDCompiledMissionBranch& Branch);
+};
+
+/**
+ * @brief Compiled lookup data of a mission, stored at index 'mID - 1'. Read when filling the lookup maps and when resolving the tags of a mID
+ * @note Plain data, no pointers, only offsets into the other compiled arrays
+ */
+struct PDMISSIONCORE_API FPDCompiledMissionLookup
+{
+	int32 TagString = INDEX_NONE;
+	int32 TypeTagString = INDEX_NONE;
+	int32 RowNameString = INDEX_NONE;
+	int32 SourceTable = INDEX_NONE;
+
+	friend FArchive& operator<<(FArchive& Ar, FPDCompiledMissionLookup& Lookup);
+};
+
+/** @brief Bit flags of the hot per-mission data */
+enum EPDCompiledMissionFlags : uint8
+{
+	ECompiledFlag_None        = 0,
+	ECompiledFlag_Repeatable  = 1 << 0,
+	ECompiledFlag_TickPaused  = 1 << 1,
+};
+
+/**
+ * @brief All FPDMissionRow tables compiled into flat arrays. Compiled when cooked, so cooked builds can fill the mission lookups
+ *        without rewriting or dirtying any tables at startup. Hot runtime data is kept as struct-of-arrays, presentation data lives in 'MetadataStore'.
+ * @note Every array is plain data referencing the others by offset only, they are serialized in bulk and need no fixups after loading
+ */
+UCLASS(BlueprintType)
+class PDMISSIONCORE_API UPDMissionDatabase : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+	/** @brief Compiles 'SourceTables' into the flat arrays. Called automatically when cooking */
+	UFUNCTION(CallInEditor, Category = "Mission|Database")
+	void CompileSourceTables();
+#endif // WITH_EDITOR
+
+	/** @brief Number of compiled rows, which is also the highest compiled mID */
+	FORCEINLINE int32 GetNumRows() const { return Lookups.Num(); }
+
+	/** @brief Is param 'mID' within the compiled range */
+	FORCEINLINE bool IsValidMID(const int32 mID) const { return Lookups.IsValidIndex(mID - 1); }
+
+	/** @brief Compiled lookup data associated with param 'mID', nullptr if out of range */
+	const FPDCompiledMissionLookup* GetLookup(const int32 mID) const { return Lookups.IsValidIndex(mID - 1) ? &Lookups[mID - 1] : nullptr; }
+
+	/** @brief Hot data accessors, param 'mID' must be valid */
+	FORCEINLINE EPDMissionState GetStartState(const int32 mID) const { return static_cast<EPDMissionState>(HotStartStates[mID - 1]); }
+	FORCEINLINE bool HasFlag(const int32 mID, const EPDCompiledMissionFlags Flag) const { return (HotFlags[mID - 1] & Flag) != 0; }
+	FORCEINLINE int32 GetConditionIndex(const int32 mID) const { return HotConditions[mID - 1]; }
+	FORCEINLINE int32 GetTickDeltaValue(const int32 mID) const { return HotTickDeltaValues[mID - 1]; }
+	FORCEINLINE float GetTickInterval(const int32 mID) const { return HotTickIntervals[mID - 1]; }
+	FORCEINLINE float GetRepeatCooldown(const int32 mID) const { return HotRepeatCooldowns[mID - 1]; }
+
+	/** @brief Compiled branches of the mission associated with param 'mID', in priority order */
+	TConstArrayView<FPDCompiledMissionBranch> GetBranches(const int32 mID) const { return MakeArrayView(Branches.GetData() + HotFirstBranches[mID - 1], HotNumBranches[mID - 1]); }
+
+	/**
+	 * @brief Evaluates the tags and the compiled expression of the condition at param 'ConditionIndex'. INDEX_NONE is an empty condition and always passes
+	 * @param ExpandedTags 'ActorTags' including all parent tags, see IPDMissionInterface::GetExpandedTagContainer
+	 */
+	bool EvaluateCondition(const int32 ConditionIndex, const TSet<FGameplayTag>& ActorTags, const TSet<FGameplayTag>& ExpandedTags) const;
+
+	/** @brief Cold metadata store, soft referenced so it only loads when something asks for it. Never loaded on dedicated servers */
+	class UPDMissionMetadataStore* LoadMetadataStore() const;
+
+	/** @brief Compiled condition at param 'ConditionIndex', nullptr if out of range */
+	const FPDCompiledMissionCondition* GetCondition(const int32 ConditionIndex) const { return Conditions.IsValidIndex(ConditionIndex) ? &Conditions[ConditionIndex] : nullptr; }
+
+	/** @brief String-table indices of the tags used by param 'Condition', required tags first */
+	TConstArrayView<int32> GetConditionTags(const FPDCompiledMissionCondition& Condition) const { return MakeArrayView(ConditionTags.GetData() + Condition.FirstTag, Condition.NumRequiredTags + Condition.NumOptionalTags); }
+
+	/** @brief Interns the tags of the compiled condition at param 'ConditionIndex', INDEX_NONE interns the empty set */
+	FPDMissionTagSetHandle InternConditionTags(const int32 ConditionIndex) const;
+
+	/** @brief Assets to preload for the mission associated with param 'mID', which must be valid */
+	TConstArrayView<TSoftObjectPtr<UObject>> GetPreloadAssets(const int32 mID) const { return MakeArrayView(PreloadAssets.GetData() + FirstPreloadAssets[mID - 1], NumPreloadAssets[mID - 1]); }
+
+	/** @brief Gameplay tag stored at param 'StringIndex', resolved once after loading */
+	FGameplayTag GetTag(const int32 StringIndex) const { return ResolvedTags.IsValidIndex(StringIndex) ? ResolvedTags[StringIndex] : FGameplayTag::EmptyTag; }
+
+	/** @brief Name stored at param 'StringIndex', resolved once after loading */
+	FName GetName(const int32 StringIndex) const { return ResolvedNames.IsValidIndex(StringIndex) ? ResolvedNames[StringIndex] : NAME_None; }
+
+public:
+	/** @brief Datatables of row-type FPDMissionRow to compile, mIDs are assigned in this order */
+	UPROPERTY(EditAnywhere, Category = "Mission|Database", Meta = (RequiredAssetDataTags="RowStructure=/Script/PDMissionCore.PDMissionRow"))
+	TArray<TSoftObjectPtr<UDataTable>> SourceTables {};
+
+	/** @brief Store holding the cold presentation data of the compiled missions */
+	UPROPERTY(EditAnywhere, Category = "Mission|Database")
+	TSoftObjectPtr<class UPDMissionMetadataStore> MetadataStore {};
+
+	/** @brief Preload assets of all compiled missions, back to back. Soft references, so they are serialized as a property rather than in bulk */
+	UPROPERTY(VisibleAnywhere, Category = "Mission|Database")
+	TArray<TSoftObjectPtr<UObject>> PreloadAssets {};
+
+protected:
+	/** @brief Resolves the string table into names and tags */
+	void ResolveStringTable();
+
+#if WITH_EDITOR
+	/** @brief Adds a string to the string table, deduplicated. @return string index */
+	int32 AddString(const FString& InString, TMap<FString, int32>& StringIndices);
+
+	/** @brief Compiles a tag compound and a condition expression into the condition arrays. @return condition index, INDEX_NONE if both are empty */
+	int32 AddCondition(const FPDMissionTagCompound& Compound, const TArray<FPDMissionConditionNode>& Expression, TMap<FString, int32>& StringIndices);
+#endif // WITH_EDITOR
+
+	/** @brief Hot per-mission data, struct-of-arrays indexed by 'mID - 1'. This is what rule evaluation reads */
+	TArray<uint8> HotStartStates;
+	TArray<uint8> HotFlags;
+	TArray<int32> HotConditions;
+	TArray<int32> HotFirstBranches;
+	TArray<int32> HotNumBranches;
+	TArray<int32> HotTickDeltaValues;
+	TArray<float> HotTickIntervals;
+	TArray<float> HotRepeatCooldowns;
+	
+	/** @brief Lookup data, indexed by 'mID - 1'. Read when filling the lookup maps and when resolving the tags of a mID */
+	TArray<FPDCompiledMissionLookup> Lookups;
+	/** @brief Compiled branch tables, each row references a contiguous range */
+	TArray<FPDCompiledMissionBranch> Branches;
+	/** @brief Compiled conditions, each references a contiguous range of 'ConditionTags' */
+	TArray<FPDCompiledMissionCondition> Conditions;
+	/** @brief String-table indices of condition tags */
+	TArray<int32> ConditionTags;
+	/** @brief Compiled condition expression programs, each condition references a contiguous range */
+	TArray<FPDMissionConditionInstr> ConditionCode;
+	/** @brief Range into 'PreloadAssets' of each mission, indexed by 'mID - 1' */
+	TArray<int32> FirstPreloadAssets;
+	TArray<int32> NumPreloadAssets;
+	/** @brief String table, utf-8 null-terminated strings stored back to back */
+	TArray<uint8> StringData;
+	/** @brief Offset into 'StringData' for each string index */
+	TArray<int32> StringOffsets;
+
+	/** @brief Runtime only, resolved after loading */
+	TArray<FName> ResolvedNames;
+	TArray<FGameplayTag> ResolvedTags;
+	/** @brief Runtime only, 'ConditionTags' resolved, so condition evaluation does not go through the string table. Doubles as the tag table of the expression programs */
+	TArray<FGameplayTag> ResolvedConditionTags;
+};
+
+/**
+ * @brief Cold presentation data of the compiled missions, indexed by 'mID - 1'.
+ * @note Excluded from dedicated servers. Compiled from the databases source tables when cooked.
+ */
+UCLASS(BlueprintType)
+class PDMISSIONCORE_API UPDMissionMetadataStore : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool NeedsLoadForServer() const override { return false; }
+
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+	/** @brief Compiles the metadata of 'Database's source tables. Called automatically when cooking */
+	UFUNCTION(CallInEditor, Category = "Mission|Database")
+	void CompileFromDatabase();
+#endif // WITH_EDITOR
+
+	/** @brief Metadata associated with param 'mID', nullptr if out of range */
+	const FPDMissionMetadata* GetMetadata(const int32 mID) const { return Metadata.IsValidIndex(mID - 1) ? &Metadata[mID - 1] : nullptr; }
+
+	/** @brief Database this store was compiled for */
+	UPROPERTY(EditAnywhere, Category = "Mission|Database")
+	TSoftObjectPtr<UPDMissionDatabase> Database {};
+
+protected:
+	/** @brief Compiled metadata, indexed by 'mID - 1' */
+	UPROPERTY(VisibleAnywhere, Category = "Mission|Database")
+	TArray<FPDMissionMetadata> Metadata {};
+};
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
@@ -0,0 +1,231 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Data/PDMissionCondition.h"
+
+#include "PDMissionPool.generated.h"
+
+UENUM()
+enum EPDMissionRotationPeriod
+{
+	ERotationDaily,  // New rotation every day, at midnight UTC
+	ERotationWeekly, // New rotation every seven days, counted from the start of the UTC epoch
+};
+
+/**
+ * @brief One weighted entry of a mission pool, every mission whose base tag matches 'MissionFilterTag' is a member
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionPoolEntry
+{
+	GENERATED_BODY()
+
+	/** @brief Missions whose base tag is, or is a child of, this tag are drawn from this entry */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Pool")
+	FGameplayTag MissionFilterTag;
+
+	/** @brief Relative weight of each mission of the entry, missions with a weight of zero are never drawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Pool", Meta = (ClampMin = 0))
+	float Weight = 1.0f;
+
+	/** @brief Additional eligibility condition, evaluated against the actor the missions are drawn for. Same format as FPDMissionRules::ConditionExpression */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Pool")
+	TArray<FPDMissionConditionNode> Condition;
+};
+
+/**
+ * @brief Mission pool definition, i.e. the possible missions of a bounty board
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionPoolDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Pool")
+	FGameplayTag PoolTag;
+
+	/** @brief Entries in priority order, a mission matching several entries uses the first one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Pool")
+	TArray<FPDMissionPoolEntry> Entries;
+};
+
+/**
+ * @brief Daily/weekly rotation, a deterministic selection out of a pool that server and clients compute on their own
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionRotationDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rotation")
+	FGameplayTag RotationTag;
+
+	/** @brief Pool the rotation selects from, membership follows the mission base tag hierarchy of the pool entries */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rotation")
+	FGameplayTag PoolTag;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rotation")
+	TEnumAsByte<EPDMissionRotationPeriod> Period = EPDMissionRotationPeriod::ERotationDaily;
+
+	/** @brief Number of missions in each rotation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rotation", Meta = (ClampMin = 1))
+	int32 Count = 3;
+
+	/** @brief Mixed into the seed of every rotation, change it to reshuffle all rotations */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rotation")
+	int32 Seed = 0;
+
+	/** @brief Index of the period 'UtcTime' falls into */
+	int64 GetPeriodIndex(const FDateTime& UtcTime) const;
+
+	/** @brief Seed of the rotation for 'PeriodIndex'. Built from stable hashes only, so it is the same in every process */
+	uint32 MakeRotationSeed(int64 PeriodIndex, int32 Salt) const;
+};
+
+/**
+ * @brief Alias table (Vose), draws a weighted index in O(1)
+ */
+struct PDMISSIONCORE_API FPDMissionAliasTable
+{
+	/** @brief Builds the table from 'Weights', O(n). Weights need to be positive */
+	void Build(TConstArrayView<float> Weights);
+
+	/** @brief Draws an index, weighted by the weights the table was built from */
+	int32 Sample(const FRandomStream& Stream) const;
+
+	FORCEINLINE bool IsEmpty() const { return Probabilities.IsEmpty(); }
+	FORCEINLINE int32 Num() const { return Probabilities.Num(); }
+
+	TArray<float> Probabilities;
+	TArray<int32> Aliases;
+};
+
+/**
+ * @brief Compiled mission pool, the members of all entries flattened with their weights and a single alias table over all of them
+ */
+struct PDMISSIONCORE_API FPDMissionPool
+{
+	/** @brief Flattens 'Definition' against the mission lookup and builds the alias table */
+	void Compile(const FPDMissionPoolDefinition& Definition, const TMap<FGameplayTag, int32>& MissionTagToMIDLookup);
+
+	/**
+	 * @brief Draws up to 'Count' distinct members out of 'Remaining', appending their mIDs to 'OutMIDs'. Drawn members are cleared from 'Remaining'
+	 * @note Samples the compiled table and rejects ineligible members. Re-tabulates over the remaining members once more than half of
+	 *       the sampled tables weight is ineligible, so each draw stays O(1) expected
+	 * @return Number of drawn missions, less than 'Count' if the eligible members ran out
+	 */
+	int32 Draw(int32 Count, TBitArray<>& Remaining, double RemainingWeight, const FRandomStream& Stream, TArray<int32>& OutMIDs) const;
+
+	/**
+	 * @brief Draws a rotation of up to 'Count' distinct members, ignoring eligibility. Only depends on the pool and 'Seed'
+	 * @note Members are ordered by mission tag name rather than mID, so the same missions and seed give the same rotation on server and clients regardless of table load order
+	 */
+	void DrawRotation(int32 Count, uint32 Seed, TArray<int32>& OutMIDs) const;
+
+	FORCEINLINE int32 Num() const { return MemberMIDs.Num(); }
+
+	/** @brief mID of each member, ordered by mission tag name */
+	TArray<int32> MemberMIDs;
+	/** @brief Weight of each member */
+	TArray<float> MemberWeights;
+	/** @brief Entry each member was taken from, indexes 'EntryConditions' */
+	TArray<int32> MemberEntries;
+	/** @brief Compiled condition of each entry */
+	TArray<FPDMissionConditionProgram> EntryConditions;
+	/** @brief Alias table over all members */
+	FPDMissionAliasTable AliasTable;
+	/** @brief Sum of 'MemberWeights' */
+	double TotalWeight = 0.0;
+};
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
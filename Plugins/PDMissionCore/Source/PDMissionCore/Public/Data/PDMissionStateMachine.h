@@ -0,0 +1,196 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PDMissionCommon.h"
+#include "Stats/Stats.h"
+
+#include "PDMissionStateMachine.generated.h"
+
+/* Forward declarations */
+struct FPDMissionNetDatum;
+
+DECLARE_STATS_GROUP(TEXT("PDMission"), STATGROUP_PDMission, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Mission transitions"), STAT_PDMissionTransitions, STATGROUP_PDMission, PDMISSIONCORE_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Illegal mission transitions"), STAT_PDMissionIllegalTransitions, STATGROUP_PDMission, PDMISSIONCORE_API);
+
+UENUM()
+enum EPDMissionEvent
+{
+	EEventUnlock,     // Unlock a locked mission
+	EEventActivate,   // Enable an unlocked mission, i.e. when granted to an actor
+	EEventTrigger,    // Branch trigger, enables the mission whether it has been unlocked or not
+	EEventDelay,      // Start a timed transition, the mission stays pending until its deadline
+	EEventComplete,   // Finish the mission successfully
+	EEventFail,       // Finish the mission unsuccessfully
+	EEventReset,      // Return a finished mission to the inactive state, i.e. when the cooldown of a repeatable mission expires
+	EINVALID_EVENT,
+};
+
+/** @brief Side effects of a transition, applied together with the state change */
+enum EPDMissionTransitionEffect : uint8
+{
+	ETransitionEffect_None          = 0,
+	ETransitionEffect_SetDeadline   = 1 << 0, // Entering a timed state, the deadline is passed along with the event and required
+	ETransitionEffect_ClearDeadline = 1 << 1, // Leaving a timed state
+	ETransitionEffect_SetCooldown   = 1 << 2, // Finishing a mission, a repeatable mission passes its cooldown expiry along with the event, otherwise the deadline is cleared
+};
+
+/** @brief A single cell of the transition matrix, 'To' is EINVALID_STATE for illegal transitions */
+struct FPDMissionTransition
+{
+	uint8 To = EPDMissionState::EINVALID_STATE;
+	uint8 Effects = ETransitionEffect_None;
+};
+
+/**
+ * @brief Every legal mission state transition, as a (from-state x event) matrix.
+ * @note Every state change on a tracker is an event applied through here, see UPDMissionTracker::TransitionMission. Raw datum writes are limited to a single step of the matrix,
+ *       and transactions fold their staged events through it. Illegal transitions are rejected and counted in 'STAT_PDMissionIllegalTransitions'.
+ *       Only group trackers copying existing state between members bypass it
+ */
+struct PDMISSIONCORE_API FPDMissionStateMachine
+{
+	static constexpr FPDMissionTransition Illegal{};
+	static constexpr FPDMissionTransition Transitions[EPDMissionState::EINVALID_STATE][EPDMissionEvent::EINVALID_EVENT] =
+	{
+		// Unlock, Activate, Trigger, Delay, Complete, Fail, Reset
+		/* ECompleted */ {Illegal, Illegal, Illegal, Illegal, Illegal, Illegal, {EInactive, ETransitionEffect_ClearDeadline}},
+		/* EFailed    */ {Illegal, Illegal, Illegal, Illegal, Illegal, Illegal, {EInactive, ETransitionEffect_ClearDeadline}},
+		/* EActive    */ {Illegal, Illegal, Illegal, Illegal, {ECompleted, ETransitionEffect_SetCooldown}, {EFailed}, Illegal},
+		/* EInactive  */ {Illegal, {EActive}, {EActive}, {EPending, ETransitionEffect_SetDeadline}, Illegal, Illegal, Illegal},
+		/* ELocked    */ {{EInactive}, Illegal, {EActive}, {EPending, ETransitionEffect_SetDeadline}, Illegal, Illegal, Illegal},
+		/* EPending   */ {{EInactive, ETransitionEffect_ClearDeadline}, Illegal, {EActive, ETransitionEffect_ClearDeadline}, Illegal, Illegal, Illegal, Illegal},
+	};
+
+	/** @brief Matrix cell for the transition, out of range states or events resolve to an illegal transition */
+	static constexpr const FPDMissionTransition& Lookup(const uint8 From, const uint8 Event)
+	{
+		return From < EPDMissionState::EINVALID_STATE && Event < EPDMissionEvent::EINVALID_EVENT ? Transitions[From][Event] : Illegal;
+	}
+
+	/** @brief Is the transition legal, does not count anything */
+	static constexpr bool IsLegal(const uint8 From, const uint8 Event) { return Lookup(From, Event).To != EPDMissionState::EINVALID_STATE; }
+
+	/** @brief Same as IsLegal, but counts the rejection if it is not */
+	static bool Validate(uint8 From, uint8 Event);
+
+	/** @brief First event that takes a mission from state 'From' straight to state 'To', EINVALID_EVENT if no single transition does */
+	static constexpr EPDMissionEvent FindStep(const uint8 From, const uint8 To)
+	{
+		for (uint8 Event = 0; Event < EPDMissionEvent::EINVALID_EVENT; Event++)
+		{
+			if (To != EPDMissionState::EINVALID_STATE && Lookup(From, Event).To == To) { return static_cast<EPDMissionEvent>(Event); }
+		}
+		return EINVALID_EVENT;
+	}
+
+	/**
+	 * @brief Same as FindStep, but counts the rejection if no single transition goes from 'From' to 'To'
+	 * @note Used to turn raw state writes into the event they stand for, so the events side effects are applied with them
+	 */
+	static EPDMissionEvent ValidateStep(uint8 From, uint8 To);
+
+	/**
+	 * @brief Applies the transition and its side effects to 'Datum'. Leaves the datum untouched if the transition is illegal, or if it enters a timed state without a deadline
+	 * @param DeadlineSeconds Server world time of the deadline or cooldown expiry, only used by transitions that set one
+	 */
+	static bool Apply(FPDMissionNetDatum& Datum, EPDMissionEvent Event, double DeadlineSeconds = 0.0);
+
+	/** @brief Event that a branch behaviour results in once its delay, if any, has passed */
+	static constexpr EPDMissionEvent GetBranchEvent(const EPDMissionBranchBehaviour Behaviour) { return Behaviour == EPDMissionBranchBehaviour::EUnlock ? EEventUnlock : EEventTrigger; }
+};
+
+static_assert(FPDMissionStateMachine::IsLegal(EPDMissionState::EPending, EEventDelay) == false, "A pending mission may not be re-triggered while pending");
+static_assert(FPDMissionStateMachine::IsLegal(EPDMissionState::EActive, EEventUnlock) == false, "Unlocking may never demote an active mission");
+static_assert(FPDMissionStateMachine::FindStep(EPDMissionState::EInactive, EPDMissionState::ECompleted) == EINVALID_EVENT, "A mission may not be completed without being active");
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
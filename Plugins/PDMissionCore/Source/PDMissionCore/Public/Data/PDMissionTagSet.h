@@ -0,0 +1,218 @@
+/* @author: Ario Amin @ Permafrost Development. @copyright: Full BSL(1.1) License included at bottom of the file  */
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+#include <atomic>
+
+#include "PDMissionTagSet.generated.h"
+
+/* Forward declarations */
+struct FPDMissionTagCompound;
+
+/**
+ * @brief Immutable, interned tag set. Tags are kept sorted so equal sets always intern to the same entry
+ * @note Owned by FPDMissionTagSetPool, never modified nor freed once interned
+ */
+struct PDMISSIONCORE_API FPDMissionTagSet
+{
+	/**
+	 * @brief Checks that every required tag, and at least one optional tag if there are any, exist in 'ActorTags'
+	 * @note Pass the expanded tag container of the actor for hierarchical matching
+	 */
+	bool IsSatisfiedBy(const TSet<FGameplayTag>& ActorTags) const;
+
+	/** @brief Same semantics as FPDMissionTagCompound::CallerHasRequiredTags */
+	bool CallerHasRequiredTags(const AActor* Caller) const;
+
+	bool IsEmpty() const { return RequiredTags.IsEmpty() && OptionalTags.IsEmpty(); }
+
+	TArray<FGameplayTag> RequiredTags;
+	TArray<FGameplayTag> OptionalTags;
+	uint32 Hash = 0;
+};
+
+/**
+ * @brief Small handle into the global tag set pool. Copy and equality are plain integer operations
+ * @note Index is only valid within the running process. Replication sends the shared index of the set instead, see FPDMissionTagSetPool::SetSharedSets
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionTagSetHandle
+{
+	GENERATED_BODY()
+
+	FPDMissionTagSetHandle() = default;
+	explicit FPDMissionTagSetHandle(int32 _Index) : Index(_Index) {}
+
+	/** @brief Resolves the handle, an unset handle resolves to the empty set */
+	const FPDMissionTagSet& Get() const;
+
+	bool IsEmpty() const { return Index == 0; }
+
+	/** @brief Writes the shared index of the set, resolved from the receivers own shared sets. Only sets that are not shared fall back to writing their tags */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FPDMissionTagSetHandle& Other) const { return Index == Other.Index; }
+	bool operator!=(const FPDMissionTagSetHandle& Other) const { return Index != Other.Index; }
+	friend uint32 GetTypeHash(const FPDMissionTagSetHandle& Handle) { return GetTypeHash(Handle.Index); }
+
+	/** @brief Index into the pool, 0 is always the empty set */
+	int32 Index = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FPDMissionTagSetHandle> : public TStructOpsTypeTraitsBase2<FPDMissionTagSetHandle>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+/**
+ * @brief Global pool of interned tag sets. Rows intern their condition handler once when the tables are processed,
+ *        datums only carry the handle around instead of owning copies of the sets
+ * @note Entries are never removed nor moved, the pool only grows with the number of unique sets. Resolving takes no lock, only interning does
+ */
+class PDMISSIONCORE_API FPDMissionTagSetPool
+{
+public:
+	static FPDMissionTagSetPool& Get();
+
+	/** @brief Interns the tags of the compound. @return Handle to the existing entry if an equal set has been interned before */
+	FPDMissionTagSetHandle Intern(const FPDMissionTagCompound& Compound);
+
+	/** @brief Interns the given tags, arrays are sorted in place and moved into the pool if no equal set exists */
+	FPDMissionTagSetHandle Intern(TArray<FGameplayTag>&& RequiredTags, TArray<FGameplayTag>&& OptionalTags);
+
+	/** @brief Resolves 'Handle', invalid handles resolve to the empty set. Lock-free */
+	const FPDMissionTagSet& Resolve(const FPDMissionTagSetHandle& Handle) const;
+
+	int32 Num() const;
+
+	/**
+	 * @brief Sets the shared sets, the condition sets of the missions indexed by 'mID - 1'. Server and clients build them from the same tables,
+	 *        so a set is replicated as the lowest shared index using it rather than as its tags
+	 * @note Game thread only, called by the mission utility whenever its rows change
+	 */
+	void SetSharedSets(const TArray<FPDMissionTagSetHandle>& InSharedSets);
+
+	/** @brief Lowest shared index of 'Handle', INDEX_NONE if the set is not shared. Game thread only */
+	int32 FindSharedIndex(const FPDMissionTagSetHandle& Handle) const;
+
+	/** @brief Handle of the set at 'SharedIndex', the empty set if out of range. Game thread only */
+	FPDMissionTagSetHandle ResolveSharedIndex(int32 SharedIndex) const;
+
+private:
+	FPDMissionTagSetPool();
+
+	/** @brief Entry at 'Index', which must be below 'NumEntries' */
+	const FPDMissionTagSet& GetEntry(const int32 Index) const { return Chunks[Index / ChunkSize][Index % ChunkSize]; }
+
+	/** @brief Sets are stored in fixed size chunks that are never moved, so references stay valid and readers need no lock while the pool grows */
+	static constexpr int32 ChunkSize = 256;
+	static constexpr int32 MaxChunks = 1024;
+	TUniquePtr<FPDMissionTagSet[]> Chunks[MaxChunks];
+
+	/** @brief Published after an entry has been fully written, readers never look past it */
+	std::atomic<int32> NumEntries{0};
+
+	TMultiMap<uint32, int32> HashToIndex;
+	mutable FRWLock PoolLock;
+
+	/** @brief Condition sets of the missions, and the lowest shared index of each interned set in it */
+	TArray<FPDMissionTagSetHandle> SharedSets;
+	TMap<int32, int32> HandleToSharedIndex;
+};
+
+
+/**
+Business Source License 1.1
+
+Parameters
+
+Licensor:             Ario Amin (@ Permafrost Development)
+Licensed Work:        PDOpenSource (Source available on github)
+                      The Licensed Work is (c) 2024 Ario Amin (@ Permafrost Development)
+Additional Use Grant: You may make commercial use of the Licensed Work provided these three additional conditions as met; 
+                      	1. Must give attributions to the original author of the Licensed Work, in 'Credits' if that is applicable.
+                      	2. The Licensed Work must be Compiled before being redistributed.
+                      	3. The Licensed Work Source may not be packaged into the product or service being sold
+
+                      "Credits" indicate a scrolling screen with attributions. This is usually in a products end-state
+
+                      "Compiled" form means the compiled bytecode, object code, binary, or any other
+                      form resulting from mechanical transformation or translation of the Source form.
+                      
+                      "Source" form means the source code (.h & .cpp files) contained in the different modules in PDOpenSource.
+                      This will usually be written in human-readable format.
+
+                      "Package" means the collection of files distributed by the Licensor, and derivatives of that collection
+                      and/or of the files or codes therein..  
+
+Change Date:          2028-04-17
+
+Change License:       Apache License, Version 2.0
+
+For information about alternative licensing arrangements for the Software,
+please visit: N/A
+
+Notice
+
+The Business Source License (this document, or the “License”) is not an Open Source license.
+However, the Licensed Work will eventually be made available under an Open Source License, as stated in this License.
+
+License text copyright (c) 2017 MariaDB Corporation Ab, All Rights Reserved.
+“Business Source License” is a trademark of MariaDB Corporation Ab.
+
+-----------------------------------------------------------------------------
+
+Business Source License 1.1
+
+Terms
+
+The Licensor hereby grants you the right to copy, modify, create derivative works, redistribute, and make non-production use of the Licensed Work.
+The Licensor may make an Additional Use Grant, above, permitting limited production use.
+
+Effective on the Change Date, or the fourth anniversary of the first publicly available distribution of a specific version of the Licensed Work under this License,
+whichever comes first, the Licensor hereby grants you rights under the terms of the Change License, and the rights granted in the paragraph above terminate.
+
+If your use of the Licensed Work does not comply with the requirements currently in effect as described in this License, you must purchase a
+commercial license from the Licensor, its affiliated entities, or authorized resellers, or you must refrain from using the Licensed Work.
+
+All copies of the original and modified Licensed Work, and derivative works of the Licensed Work, are subject to this License. This License applies
+separately for each version of the Licensed Work and the Change Date may vary for each version of the Licensed Work released by Licensor.
+
+You must conspicuously display this License on each original or modified copy of the Licensed Work. If you receive the Licensed Work
+in original or modified form from a third party, the terms and conditions set forth in this License apply to your use of that work.
+
+Any use of the Licensed Work in violation of this License will automatically terminate your rights under this License for the current
+and all other versions of the Licensed Work.
+
+This License does not grant you any right in any trademark or logo of Licensor or its affiliates (provided that you may use a
+trademark or logo of Licensor as expressly required by this License).
+
+TO THE EXTENT PERMITTED BY APPLICABLE LAW, THE LICENSED WORK IS PROVIDED ON AN “AS IS” BASIS. LICENSOR HEREBY DISCLAIMS ALL WARRANTIES AND CONDITIONS,
+EXPRESS OR IMPLIED, INCLUDING (WITHOUT LIMITATION) WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, NON-INFRINGEMENT, AND TITLE.
+
+MariaDB hereby grants you permission to use this License’s text to license your works, and to refer to it using the trademark
+“Business Source License”, as long as you comply with the Covenants of Licensor below.
+
+Covenants of Licensor
+
+In consideration of the right to use this License’s text and the “Business Source License” name and trademark,
+Licensor covenants to MariaDB, and to all other recipients of the licensed work to be provided by Licensor:
+
+1. To specify as the Change License the GPL Version 2.0 or any later version, or a license that is compatible with GPL Version 2.0
+   or a later version, where “compatible” means that software provided under the Change License can be included in a program with
+   software provided under GPL Version 2.0 or a later version. Licensor may specify additional Change Licenses without limitation.
+
+2. To either: (a) specify an additional grant of rights to use that does not impose any additional restriction on the right granted in
+   this License, as the Additional Use Grant; or (b) insert the text “None”.
+
+3. To specify a Change Date.
+
+4. Not to modify this License in any other way.
+ **/
\ No newline at end of file
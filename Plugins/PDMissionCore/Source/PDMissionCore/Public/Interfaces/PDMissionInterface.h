@@ -39,9 +39,28 @@ public:
 	virtual void RemoveTagsToContainer_Implementation(TArray<FGameplayTag>& DeleteTags);	
 
 	const TSet<FGameplayTag>& GetTagContainer() const { return TagContainer; }
+
+	/** @brief Bumped on every change to 'TagContainer', cached condition results of older versions are stale */
+	uint32 GetTagContainerVersion() const { return TagContainerVersion; }
+
+	/**
+	 * @brief 'TagContainer' with the parents of every tag added, so hierarchical matches are a single Contains.
+	 * @note Rebuilt lazily, the first time it is requested after the tags have changed
+	 */
+	const TSet<FGameplayTag>& GetExpandedTagContainer() const;
 protected:
+	/** @brief Needs to be called by anything that modifies 'TagContainer' directly. Refreshes the aggregated tags of the group the actor is a member of, if any */
+	void MarkTagContainerChanged();
 	
 	TSet<FGameplayTag> TagContainer;  
+
+	/** @brief Starts at 1, so it never matches a default initialized cache entry */
+	uint32 TagContainerVersion = 1;
+
+private:
+	mutable TSet<FGameplayTag> ExpandedTagContainer;
+	/** @brief 'TagContainerVersion' that 'ExpandedTagContainer' was built from */
+	mutable uint32 ExpandedTagVersion = 0;
 };
 
 
@@ -46,15 +46,33 @@ public:
 	
 	/** @brief Current State (value and limits) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = NetDatum)
-	FPDMissionState State = {EPDMissionState::EInactive, FPDMissionTagCompound{}};
+	FPDMissionState State = {EPDMissionState::EInactive};
 	
 	/** @brief Current Tick behaviour */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = StatData)
 	FPDMissionTickBehaviour TickSettings;
 
+	/**
+	 * @brief Server world time, in tenths of a second, at which a timed transition or timeout happens. 0 means no deadline
+	 * @note Only replicates when set and when cleared, clients count down locally against their synchronized server time
+	 */
+	UPROPERTY()
+	uint32 DeadlineTenths = 0;
+
+	/** @brief Does the datum have a pending deadline */
+	FORCEINLINE bool HasDeadline() const { return DeadlineTenths != 0; }
+	/** @brief Deadline in server world time seconds */
+	FORCEINLINE double GetDeadlineSeconds() const { return DeadlineTenths / 10.0; }
+	/** @brief Sets the deadline from server world time seconds, rounded up so a deadline never fires early on clients */
+	FORCEINLINE void SetDeadlineSeconds(double ServerTimeSeconds) { DeadlineTenths = EncodeDeadline(ServerTimeSeconds); }
+	/** @brief Encodes server world time seconds the way 'DeadlineTenths' stores them */
+	static FORCEINLINE uint32 EncodeDeadline(double ServerTimeSeconds) { return FMath::Max<uint32>(1, static_cast<uint32>(FMath::CeilToDouble(ServerTimeSeconds * 10.0))); }
+	/** @brief Clears the deadline */
+	FORCEINLINE void ClearDeadline() { DeadlineTenths = 0; }
+
 	friend bool operator==(const FPDMissionNetDatum& A, const FPDMissionNetDatum& B)
 	{
-		return A.mID == B.mID && A.State.Current == B.State.Current && A.State.MissionConditionHandler == B.State.MissionConditionHandler;
+		return A.mID == B.mID && A.State.Current == B.State.Current && A.State.MissionConditionHandle == B.State.MissionConditionHandle && A.DeadlineTenths == B.DeadlineTenths;
 	}
 
 	friend bool operator!=(const FPDMissionNetDatum& A, const FPDMissionNetDatum& B)
@@ -80,10 +98,39 @@ public:
 	UPROPERTY()
 	UPDMissionTracker* OwnerTracker;
 
+	/** @brief Sends a compressed snapshot the first time the array is sent to a connection whose database checksum matches ours, per-item deltas after that and to any other connection */
 	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParams);
+
+protected:
+	/**
+	 * @brief Writes all items as one snapshot and creates the base state the following deltas are compared against
+	 * @note Layout: item count, array key, database checksum, runs of consecutive (mID, ReplicationID) pairs, then runs of default/non-default items where only the non-default items carry a payload
+	 */
+	bool WriteInitialSnapshot(FNetDeltaSerializeInfo& DeltaParams);
+	
+	/**
+	 * @brief Reads a snapshot written by 'WriteInitialSnapshot' and replaces all items with it
+	 * @note Snapshots that hold more items than there are local missions, or whose checksum differs from the local database, are dropped and the full state is requested instead.
+	 *       Only happens if our missions changed after the connection reported its checksum
+	 */
+	bool ReadInitialSnapshot(FNetDeltaSerializeInfo& DeltaParams);
 };
 
 
+/**
+ * @brief Allocations of a trackers state, kept around after a user leaves so the next user to join can reuse them
+ * @note Always empty when pooled, only the capacity is carried over
+ */
+struct PDMISSIONCORE_API FPDMissionTrackerStateBlock
+{
+	TArray<FPDMissionNetDatum> Items;
+	TMap<int32, int32> mIDToReplIdMap;
+	TArray<int32> DenseItemIndices;
+	TArray<int16> DensePageIndices;
+	/** @brief Page items keyed by page tag, the acquiring tracker recreates these pages up-front if it pages by mission type */
+	TMap<FGameplayTag, TArray<FPDMissionNetDatum>> PageItems;
+};
+
 /**
  * @brief Typetraits for FFastArraySerializers. TStructOpsTypeTraits Needed for structs using NetSerialize, such as fastarray types
  */
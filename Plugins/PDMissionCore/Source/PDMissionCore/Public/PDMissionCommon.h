@@ -3,6 +3,8 @@
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
+#include "Data/PDMissionTagSet.h"
+#include "Data/PDMissionCondition.h"
 
 #include <Curves/CurveFloat.h>
 #include <Engine/DataTable.h>
@@ -35,8 +37,41 @@ enum EPDMissionState
 /** @brief Called when a mission updated, used it's mID */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FPDUpdateMission, int32, mID, EPDMissionState, vNewState);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FPDTickMission, int32, mID, FPDUpdateMission, UpdateFunction);
+/** @brief Called once per flush with every mission that changed since the last flush, used with coalesced tracker updates */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPDUpdateMissionBatch, const TArray<int32>&, UpdatedMIDs);
 typedef TMap<int32, FPDUpdateMission> FPDMissionTreeMap;
 
+/**
+ * @brief Resolved reference to a mission. Holds the dense index of the mission in the subsystems lookup data and the database generation it was resolved against.
+ * @note Resolve once via 'FPDMissionUtility::ResolveHandle' and keep it around. Handles become stale when the mission tables are rebuilt or edited, stale handles are rejected.
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionHandle
+{
+	GENERATED_BODY()
+
+	FPDMissionHandle() = default;
+	FPDMissionHandle(int32 _Index, int32 _Generation) : Index(_Index), Generation(_Generation) {}
+
+	/** @brief Has this handle been resolved at all. Does not check if it has gone stale */
+	FORCEINLINE bool IsSet() const { return Index != INDEX_NONE; }
+
+	/** @brief The dense index is always the mID offset by one */
+	FORCEINLINE int32 GetMID() const { return IsSet() ? Index + 1 : INDEX_NONE; }
+
+	friend bool operator==(const FPDMissionHandle& A, const FPDMissionHandle& B) { return A.Index == B.Index && A.Generation == B.Generation; }
+	friend bool operator!=(const FPDMissionHandle& A, const FPDMissionHandle& B) { return (A == B) == false; }
+	friend uint32 GetTypeHash(const FPDMissionHandle& Handle) { return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation)); }
+
+	/** @brief Dense index of the mission */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mission|Handle")
+	int32 Index = INDEX_NONE;
+
+	/** @brief Database generation this handle was resolved against */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mission|Handle")
+	int32 Generation = INDEX_NONE;
+};
+
 
 /**
  *	@brief Static functions exposed to blueprint
@@ -54,7 +89,15 @@ public:
 	/** @brief Creates a row-handle structure */
 	UFUNCTION(BlueprintCallable)
 	static FDataTableRowHandle CreateRowHandle(class UDataTable* Table, FName RowName);
-	
+
+	/** @brief Resolves a mission handle from a mission tag. Store the handle and reuse it for repeated queries */
+	UFUNCTION(BlueprintCallable)
+	static FPDMissionHandle ResolveMissionHandle(const FGameplayTag& MissionBaseTag);
+
+	/** @brief Server world time in seconds, synchronized on clients through the game state. Falls back to local world time if there is no game state yet */
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject"))
+	static double GetServerWorldTime(const UObject* WorldContextObject);
+
 private:	
 };
 
@@ -117,7 +160,10 @@ struct PDMISSIONCORE_API FPDMissionTagCompound
 	bool operator==(const FPDMissionTagCompound& Other) const;
 	bool operator==(const FPDMissionTagCompound&& Other) const;
 
-	/** @brief Optional tags that need to exist on the actor requesting this mission for it to be approved, Set to not being editable so they are greyed out from the datatable editor */
+	/** @brief Read-only access to the required tags, used when compiling conditions */
+	const TSet<FGameplayTag>& GetRequiredMissionTags() const { return RequiredMissionTags; }
+
+	/** @brief Optional tags, at least one of them needs to exist on the actor requesting this mission for it to be approved. Set to not being editable so they are greyed out from the datatable editor */
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Mission|Datum")
 	TSet<FGameplayTag> OptionalUserTags{};
 
@@ -136,16 +182,16 @@ USTRUCT(BlueprintType)
 struct PDMISSIONCORE_API FPDMissionState
 {
 	GENERATED_BODY()
-	FPDMissionState(EPDMissionState _CurrrentState = EPDMissionState::EInactive, TArray<FGameplayTag> _RequiredMissionTags = {}) : Current(_CurrrentState), MissionConditionHandler(_RequiredMissionTags) {};
-	FPDMissionState(EPDMissionState _CurrrentState, const FPDMissionTagCompound&_OtherHandler) : Current(_CurrrentState), MissionConditionHandler(_OtherHandler) {};
+	FPDMissionState(EPDMissionState _CurrrentState = EPDMissionState::EInactive, FPDMissionTagSetHandle _ConditionHandle = {}) : Current(_CurrrentState), MissionConditionHandle(_ConditionHandle) {};
+	FPDMissionState(EPDMissionState _CurrrentState, const FPDMissionTagCompound&_OtherHandler) : Current(_CurrrentState), MissionConditionHandle(FPDMissionTagSetPool::Get().Intern(_OtherHandler)) {};
 	
 	/** @brief Current mission state */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Mission|Datum")
 	TEnumAsByte<EPDMissionState> Current;
 	
-	/** @brief Tags that need to exist on the actor requesting this mission for it to be approved */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Mission|Datum")
-	FPDMissionTagCompound MissionConditionHandler{};
+	/** @brief Interned tags that need to exist on the actor requesting this mission for it to be approved. Shared with every other datum using the same set */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mission|Datum")
+	FPDMissionTagSetHandle MissionConditionHandle{};
 	
 };
 
@@ -204,12 +250,10 @@ struct PDMISSIONCORE_API FPDDelayMissionFunctor
 
 	FPDDelayMissionFunctor() : bHasRun(false) {};
 	FPDDelayMissionFunctor(uint8 _bHasRun) : bHasRun(_bHasRun) {};
-	FPDDelayMissionFunctor(UPDMissionTracker* Tracker, const FDataTableRowHandle& Target, const FPDMissionBranchBehaviour& TargetBehaviour);
+	FPDDelayMissionFunctor(UPDMissionTracker* Tracker, int32 TargetMID, const FPDMissionBranchBehaviour& TargetBehaviour);
 
 	UPROPERTY()
 	uint8 bHasRun : 1;
-	
-	TMap<FTimerHandle, FTimerDelegate> OutHandlesMap{};
 };
 
 
@@ -225,10 +269,23 @@ struct FPDMissionBranchElement
 	UPROPERTY(EditAnywhere, Category = "Mission Subsystem", Meta = (RowType="/Script/PDMissionCore.PDMissionRow"))
 	FDataTableRowHandle Target;
 
+	/** @brief Checks both 'BranchConditions' and the compiled 'BranchExpression' against the tags of 'Caller' */
+	bool EvaluateConditions(const AActor* Caller) const;
+
 	/** @brief Actual condition to be able to branch to the target */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Mission|Datum")
 	FPDMissionTagCompound BranchConditions;
 
+	/** @brief Additional condition expression to be able to branch to the target, in prefix order. Compiled when the tables are processed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Datum")
+	TArray<FPDMissionConditionNode> BranchExpression;
+
+	/** @brief Compiled 'BranchExpression' */
+	FPDMissionConditionProgram CompiledBranchExpression;
+
+	/** @brief mID of 'Target', resolved when the tables are processed */
+	int32 TargetMID = INDEX_NONE;
+
 	/** @brief true means it's a direct branch, i.e. 'same questline', false means it's a new questline */
 	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
 	uint8 bIsDirectBranch : 1;
@@ -264,15 +321,28 @@ struct FPDMissionRules
 
 public:
 	FPDMissionRules(): bRepeatable(0) {};
-	FPDMissionRules(FPDMissionTagCompound _MissionConditionHandler, FPDMissionBranch _NextMissionBranch, uint8 bRepeatable)
-		: MissionConditionHandler(_MissionConditionHandler), NextMissionBranch(_NextMissionBranch) ,bRepeatable(0) {};
+	FPDMissionRules(FPDMissionTagCompound _MissionConditionHandler, FPDMissionBranch _NextMissionBranch, uint8 _bRepeatable, float _RepeatCooldown = 0.0f)
+		: MissionConditionHandler(_MissionConditionHandler), NextMissionBranch(_NextMissionBranch), bRepeatable(_bRepeatable), RepeatCooldown(_RepeatCooldown) {};
 	
 	void IterateStatusHandlers(const FGameplayTag& Tag, FPDFPDMissionModData& OutStatVariables);
 
+	/** @brief Compiles 'ConditionExpression' and the expressions of all branches. @return false if any of them is malformed, those are left empty */
+	bool CompileConditions();
+
+	/** @brief Checks both 'MissionConditionHandler' and the compiled 'ConditionExpression' against the tags of 'Caller' */
+	bool EvaluateConditions(const AActor* Caller) const;
+
 	/** @brief Flags that need to exist on the actor requesting this mission for it to be approved */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Mission|Rules")
 	FPDMissionTagCompound MissionConditionHandler{};
 
+	/** @brief Additional condition expression of the mission, in prefix order. Supports And/Or/Not, hierarchical and exact tag matches and tag counters */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rules")
+	TArray<FPDMissionConditionNode> ConditionExpression;
+
+	/** @brief Compiled 'ConditionExpression' */
+	FPDMissionConditionProgram CompiledConditionExpression;
+
 	/** @brief Branching conditions for this mission  */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rules")
 	FPDMissionBranch NextMissionBranch;
@@ -284,6 +354,10 @@ public:
 	/** @brief If we get the mission again after finishing it, are we allowed to retrigger it? */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rules")
 	uint8 bRepeatable : 1; 
+
+	/** @brief Seconds after finishing a repeatable mission before it returns to inactive and can be granted again */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Rules", Meta = (EditCondition = "bRepeatable", ClampMin = 0))
+	float RepeatCooldown = 0.0f;
 };
 
 /**
@@ -334,7 +408,11 @@ struct PDMISSIONCORE_API FPDMissionRow : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Data")
 	FPDMissionRules ProgressRules{};
 
-	/** @brief Metadata, Friendly Name & Description */
+	/** @brief Assets the mission needs once it runs. Preloaded in the background while a mission that branches into this one is active */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Data")
+	TArray<TSoftObjectPtr<UObject>> PreloadAssets{};
+
+	/** @brief Metadata, Friendly Name & Description. Missions served from a compiled database read it from the databases metadata store instead */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Data")
 	FPDMissionMetadata Metadata {};
 };
@@ -6,11 +6,36 @@
 
 #include "CoreMinimal.h"
 #include "PDMissionUtility.h"
+#include "Data/PDMissionStateMachine.h"
 #include "Engine/NetDriver.h"
+#include <Containers/Queue.h>
 
 #include "PDMissionSubsystem.generated.h"
 
 
+/** @brief Kinds of events worker threads can post to the subsystem */
+enum EPDQueuedMissionEventType : uint8
+{
+	EQueuedTransition, // Apply 'Transition' to the mission 'Tag'
+	EQueuedFinish,     // Finish the mission 'Tag', same as FinishMission
+	EQueuedAddTags,    // Add 'Tags' to the actors tag container
+	EQueuedRemoveTags, // Remove 'Tags' from the actors tag container
+};
+
+/**
+ * @brief Mission event posted from any thread, applied on the game thread when the subsystem drains its event queue
+ */
+struct PDMISSIONCORE_API FPDQueuedMissionEvent
+{
+	EPDQueuedMissionEventType Type = EQueuedTransition;
+	EPDMissionEvent Transition = EINVALID_EVENT;
+	int32 ActorID = INDEX_NONE;
+	/** @brief Mission base tag for the mission events */
+	FGameplayTag Tag;
+	/** @brief Tags for the tag events */
+	TArray<FGameplayTag> Tags;
+};
+
 /**
  * @brief 
  */
@@ -22,17 +47,88 @@ class PDMISSIONCORE_API UPDMissionSubsystem : public UEngineSubsystem
 public:
 
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	
 	UFUNCTION(BlueprintCallable)
 	void SetMission(int32 ActorID, const FPDMissionBase& PersistentDatum);
 
 	UFUNCTION(BlueprintCallable)
 	bool FinishMission(int32 ActorID, const FPDMissionBase& PersistentDatum);
+
+	/** @brief Requests an asynchronous load of the table group associated with 'GroupTag', merges it into the lookups when done. @return false if the group is unknown or already requested */
+	UFUNCTION(BlueprintCallable)
+	bool LoadMissionTableGroup(const FGameplayTag& GroupTag);
+
+	/** @brief Removes the table group associated with 'GroupTag' from the lookups and releases its tables, cancels the request if it is still in-flight */
+	UFUNCTION(BlueprintCallable)
+	bool UnloadMissionTableGroup(const FGameplayTag& GroupTag);
+
+	/** @brief Checks if the table group associated with 'GroupTag' has been loaded and merged */
+	UFUNCTION(BlueprintCallable)
+	bool IsMissionTableGroupLoaded(const FGameplayTag& GroupTag) const;
+
+	/** @brief Friendly name & description of the mission associated with 'MissionBaseTag', read from the tables or the compiled databases metadata store */
+	UFUNCTION(BlueprintCallable)
+	FPDMissionMetadata GetMissionMetadata(const FGameplayTag& MissionBaseTag) const;
+
+	/** @brief Number of actors holding the mission in 'State', O(1). Server only */
+	UFUNCTION(BlueprintCallable)
+	int32 CountActorsInMissionState(const FGameplayTag& MissionBaseTag, TEnumAsByte<EPDMissionState> State) const;
+
+	/** @brief ActorIDs of all actors holding the mission in 'State'. Server only */
+	UFUNCTION(BlueprintCallable)
+	TArray<int32> GetActorsInMissionState(const FGameplayTag& MissionBaseTag, TEnumAsByte<EPDMissionState> State) const;
+
+	/** @brief Draws up to 'Count' distinct eligible missions out of the pool associated with 'PoolTag' for the actor associated with 'ActorID'. The same seed gives the same draw. Server only */
+	UFUNCTION(BlueprintCallable)
+	TArray<FGameplayTag> DrawMissionsFromPool(int32 ActorID, const FGameplayTag& PoolTag, int32 Count, int32 Seed);
+
+	/** @brief Missions of the rotation that 'UtcTime' falls into, computed locally on server and clients alike. 'Salt' is i.e. a player or shard id */
+	UFUNCTION(BlueprintCallable)
+	TArray<FGameplayTag> GetMissionRotation(const FGameplayTag& RotationTag, FDateTime UtcTime, int32 Salt);
+
+	/** @brief Computes the rotation that 'UtcTime' falls into on a background thread, i.e. the next one ahead of the rotation change */
+	UFUNCTION(BlueprintCallable)
+	bool PrecomputeMissionRotation(const FGameplayTag& RotationTag, FDateTime UtcTime, int32 Salt);
+
+	/**
+	 * @brief Posts an event to be applied at the start of the next frame. Safe to call from any thread, producers go through a thread-safe MPSC queue and never wait on each other, each post allocates a queue node
+	 * @note Keep a pointer to the subsystem around on the producing side, resolving it is not meant for worker threads
+	 */
+	void PostMissionEvent(FPDQueuedMissionEvent&& Event);
+
+	/**
+	 * @brief Applies all posted events, in the order they were posted. Game thread only, called at the start of every frame
+	 * @note Every tracker an event writes to, including the group tracker of shared missions, coalesces its changes for the batch
+	 */
+	void DrainMissionEvents();
+
+	/** @brief Bound to the OnDataTableChanged of every processed mission table, forwards to the utility */
+	void OnMissionTableChanged(int32 TableID);
+
+protected:
+	/** @brief Applies a single posted event */
+	void ApplyMissionEvent(const FPDQueuedMissionEvent& Event);
+
+	/** @brief Base tags of the missions associated with 'MIDs', in the same order */
+	TArray<FGameplayTag> ResolveMissionTags(const TArray<int32>& MIDs) const;
+
+	/** @brief Called by the streamable manager when a requested table group has finished loading */
+	void OnMissionTableGroupLoaded(FGameplayTag GroupTag);
+
+	/** @brief Requests the groups that are flagged with 'bLoadOnInitialize' */
+	void LoadInitialMissionTableGroups();
 	
 public:
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FPDMissionUtility Utility{};
+
+protected:
+	/** @brief Events posted by any thread, drained on the game thread */
+	TQueue<FPDQueuedMissionEvent, EQueueMode::Mpsc> QueuedMissionEvents;
+	
+	FDelegateHandle BeginFrameHandle;
 };
 
 /**
@@ -2,15 +2,212 @@
 #pragma once
 
 #include "PDMissionCommon.h"
+#include "Net/MissionDatum.h"
+#include "Data/PDMissionPool.h"
 
 #include "CoreMinimal.h"
 #include <Engine/NetDriver.h>
 #include <Engine/DataTable.h>
+#include <Async/Future.h>
 
 #include "PDMissionUtility.generated.h"
 
 class UPDMissionTracker;
-struct FPDMissionNetDatum;
+class UPDMissionSubsystem;
+class UPDMissionDatabase;
+class UPDMissionMetadataStore;
+class IPDMissionInterface;
+struct FStreamableHandle;
+
+/** @brief Called when a table group has been merged into, or removed from, the mission lookups */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FPDOnMissionTableGroupChanged, const FGameplayTag& /*GroupTag*/, bool /*bMerged*/);
+
+/**
+ * @brief A group of soft referenced mission tables that are streamed in and out together, i.e. a chapter or a region
+ */
+USTRUCT(BlueprintType)
+struct PDMISSIONCORE_API FPDMissionTableGroup
+{
+	GENERATED_BODY()
+
+	/** @brief Tag identifying the group, expected format 'Mission.Group.<Chapter/Region>' */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Streaming")
+	FGameplayTag GroupTag{};
+
+	/** @brief Datatables of row-type FPDMissionRow, loaded asynchronously when the group is requested */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Streaming", Meta = (RequiredAssetDataTags="RowStructure=/Script/PDMissionCore.PDMissionRow"))
+	TArray<TSoftObjectPtr<UDataTable>> Tables {};
+
+	/** @brief Request the group as soon as the mission subsystem has initialized */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mission|Streaming")
+	bool bLoadOnInitialize = false;
+};
+
+/**
+ * @brief Runtime state of a table group
+ * @note The streamable handle keeps the loaded tables alive, releasing it lets the tables be collected
+ */
+struct PDMISSIONCORE_API FPDMissionTableGroupState
+{
+	/** @brief Handle of the in-flight or completed load request */
+	TSharedPtr<FStreamableHandle> StreamingHandle;
+
+	/** @brief Tables that have been merged into the lookups, empty while the group is not merged */
+	TArray<UDataTable*> LoadedTables;
+
+	/** @brief First mID reserved for this group. The range is kept when unloading so a reload resolves to the same mIDs */
+	int32 FirstMID = INDEX_NONE;
+
+	/** @brief Number of mIDs reserved for this group */
+	int32 NumMIDs = 0;
+};
+
+/**
+ * @brief Hands out ActorIDs as a packed slot + generation pair. Released slots are reused, their generation is bumped so stale IDs are rejected
+ * @note Bits [0, 20) hold the slot, bits [20, 31) hold the generation. Generations start at 1 so a valid ActorID is never 0 nor negative
+ */
+struct PDMISSIONCORE_API FPDMissionActorIDAllocator
+{
+	static constexpr int32 SlotBits = 20;
+	static constexpr int32 SlotMask = (1 << SlotBits) - 1;
+	static constexpr int32 GenerationMask = (1 << (31 - SlotBits)) - 1;
+
+	/** @brief Allocates a new ActorID, reusing a freed slot if one exists. @return INDEX_NONE if all slots are in use */
+	int32 Allocate();
+
+	/** @brief Releases 'ActorID' and bumps its slots generation. @return false if the ID was already stale */
+	bool Release(const int32 ActorID);
+
+	/** @brief Checks that the slot of 'ActorID' is in use and of the same generation */
+	FORCEINLINE bool IsValid(const int32 ActorID) const
+	{
+		return ActorID > 0 && Generations.IsValidIndex(GetSlot(ActorID)) && Generations[GetSlot(ActorID)] == GetGeneration(ActorID) && bSlotInUse[GetSlot(ActorID)];
+	}
+
+	FORCEINLINE static int32 GetSlot(const int32 ActorID) { return ActorID & SlotMask; }
+	FORCEINLINE static int32 GetGeneration(const int32 ActorID) { return (ActorID >> SlotBits) & GenerationMask; }
+	FORCEINLINE static int32 MakeActorID(const int32 Slot, const int32 Generation) { return (Generation << SlotBits) | Slot; }
+
+	/** @brief Number of slots that have ever been allocated, the dense tracker array is sized after this */
+	FORCEINLINE int32 NumSlots() const { return Generations.Num(); }
+
+	/** @brief ActorID currently held by 'Slot' */
+	FORCEINLINE int32 GetActorID(const int32 Slot) const { return MakeActorID(Slot, Generations[Slot]); }
+
+private:
+	TArray<uint16> Generations;
+	TBitArray<> bSlotInUse;
+	TArray<int32> FreeSlots;
+};
+
+/**
+ * @brief Inverted index from (mID, state) to the set of actor slots that hold the mission in that state
+ * @note Sets are bitsets over actor slots, allocated the first time an actor enters the given (mID, state). Counts are kept alongside so count queries are O(1)
+ */
+struct PDMISSIONCORE_API FPDMissionStateIndex
+{
+	static constexpr int32 NumStates = EPDMissionState::EINVALID_STATE;
+
+	/** @brief Adds 'Slot' to the set of (DenseIndex, State) */
+	void Add(int32 DenseIndex, EPDMissionState State, int32 Slot);
+	/** @brief Removes 'Slot' from the set of (DenseIndex, State) */
+	void Remove(int32 DenseIndex, EPDMissionState State, int32 Slot);
+	/** @brief Number of slots in the set of (DenseIndex, State) */
+	int32 Num(int32 DenseIndex, EPDMissionState State) const;
+	/** @brief Set of (DenseIndex, State), nullptr if it was never used */
+	const TBitArray<>* Find(int32 DenseIndex, EPDMissionState State) const;
+	/** @brief Empties the index */
+	void Reset();
+
+private:
+	FORCEINLINE static int32 MakeKey(const int32 DenseIndex, const EPDMissionState State) { return DenseIndex * NumStates + State; }
+	FORCEINLINE static bool IsIndexedState(const EPDMissionState State) { return State >= 0 && State < NumStates; }
+	
+	TArray<TBitArray<>> SlotSets;
+	TArray<int32> Counts;
+};
+
+/**
+ * @brief Memoized condition results per (actor, condition id, tag container version)
+ * @note Each actor keeps the results of a single tag container version, a version or database generation change drops them all at once
+ */
+struct PDMISSIONCORE_API FPDMissionConditionCache
+{
+	/** @brief Finds a cached result. @return false if not cached for this version and generation */
+	bool Find(const AActor* Actor, uint32 TagVersion, int32 Generation, int32 ConditionID, bool& bOutResult) const;
+	/** @brief Stores a result, dropping the actors results of any older version or generation */
+	void Store(const AActor* Actor, uint32 TagVersion, int32 Generation, int32 ConditionID, bool bResult);
+	/** @brief Drops the cached results of 'Actor' */
+	void Remove(const AActor* Actor);
+	/** @brief Drops all cached results */
+	void Reset();
+
+private:
+	struct FActorEntry
+	{
+		uint32 TagVersion = 0;
+		int32 Generation = INDEX_NONE;
+		TBitArray<> bEvaluated;
+		TBitArray<> bResults;
+	};
+	TMap<TObjectKey<AActor>, FActorEntry> Entries;
+};
+
+/**
+ * @brief Background preloads of the assets of upcoming missions, keyed by the mID of the mission they belong to
+ * @note Sizes are only known once loaded, the least recently requested preloads are released when the loaded total exceeds the budget
+ */
+struct PDMISSIONCORE_API FPDMissionPreloader
+{
+	/**
+	 * @brief Requests a background load of 'Assets', or refreshes the request if the mission is already preloaded
+	 * @note The completion is bound to 'Owner' and reaches the preloader through it, a load finishing after the subsystem is gone is dropped
+	 */
+	void Request(UPDMissionSubsystem* Owner, int32 mID, TConstArrayView<TSoftObjectPtr<UObject>> Assets, int64 InBudgetBytes);
+	/** @brief Releases all preloads, cancelling the ones in-flight. Called when the owning subsystem deinitializes */
+	void Reset();
+
+	FORCEINLINE int64 GetUsedBytes() const { return UsedBytes; }
+
+private:
+	/** @brief Measures a finished preload and enforces the budget */
+	void OnPreloadFinished(int32 mID);
+	/** @brief Releases preloads, least recently requested first, until the loaded total is within budget */
+	void EnforceBudget();
+	
+	struct FPreloadEntry
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int64 SizeBytes = 0;
+		uint64 LastRequest = 0;
+		/** @brief Has finished loading and been counted against the budget */
+		bool bMeasured = false;
+	};
+	TMap<int32, FPreloadEntry> Entries;
+	int64 UsedBytes = 0;
+	int64 BudgetBytes = 0;
+	uint64 RequestCounter = 0;
+};
+
+/**
+ * @brief Key of a rotation computed ahead of time. Includes the database generation, the pools are recompiled when it changes
+ */
+struct PDMISSIONCORE_API FPDMissionRotationKey
+{
+	FGameplayTag RotationTag;
+	int64 PeriodIndex = 0;
+	int32 Salt = 0;
+	int32 Generation = INDEX_NONE;
+
+	bool operator==(const FPDMissionRotationKey& Other) const
+	{
+		return RotationTag == Other.RotationTag && PeriodIndex == Other.PeriodIndex && Salt == Other.Salt && Generation == Other.Generation;
+	}
+	friend uint32 GetTypeHash(const FPDMissionRotationKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.RotationTag), GetTypeHash(Key.PeriodIndex)), HashCombine(GetTypeHash(Key.Salt), GetTypeHash(Key.Generation)));
+	}
+};
 
 USTRUCT(BlueprintType, Blueprintable)
 struct PDMISSIONCORE_API FPDMissionUtility final
@@ -21,6 +218,9 @@ public:
 // UTILITY	
 	/** @brief Resolved the mID associated with the given tag. INDEX_NONE if nothing was found */
 	int32 ResolveMIDViaTag(const FGameplayTag& BaseTag) const;
+
+	/** @brief Resolved the mID associated with the given row name. INDEX_NONE if nothing was found. @note conflicting row names are not handled */
+	int32 ResolveMIDViaRowName(const FName& RowName) const;
 	
 	/** @brief Gets the tracker associated with the 'ActorID' */
 	UPDMissionTracker* GetActorTracker(int32 ActorID) const;
@@ -28,25 +228,55 @@ public:
 	/** @brief Gets active mission data for mission with 'mID' on the calling actor associated with the 'ActorID' */
 	FPDMissionNetDatum* GetMissionDatum(int32 ActorID, int32 SID) const;
 	
-	/** @brief Gets the mission conditions */
+	/** @brief Gets the mission conditions. Table rows only, see 'GetDefaultBase' */
 	const FPDMissionRules* GetMissionRules(const FGameplayTag& BaseTag) const;
 	
-	/** @brief Get the mission default data associated with param 'mID' */
+	/** @brief Get the table row of the mission associated with param 'mID'. nullptr for missions served from the compiled database, use the mID accessors below for anything that should work with both */
 	FPDMissionRow* GetDefaultBase(const int32 mID) const;
 	
-	/** @brief Get the mission rules associated with param 'mID' */
+	/** @brief Get the mission rules associated with param 'mID'. Table rows only, see 'GetDefaultBase' */
 	FPDMissionRules* GetMissionRules(const int32 mID) const;  
 
+	/** @brief Base tag of the mission associated with param 'mID'. Empty tag if there is no such mission */
+	FGameplayTag GetMissionBaseTag(const int32 mID) const;
+
+	/** @brief Type tag, the direct parent of the base tag, of the mission associated with param 'mID'. Empty tag if there is no such mission */
+	FGameplayTag GetMissionTypeTag(const int32 mID) const;
+
+	/** @brief State the mission associated with param 'mID' starts in. EINVALID_STATE if there is no such mission */
+	EPDMissionState GetStartState(const int32 mID) const;
+
+	/** @brief Can the mission associated with param 'mID' be granted again after finishing it */
+	bool IsRepeatable(const int32 mID) const;
+
+	/** @brief Seconds a finished repeatable mission waits before resetting to inactive */
+	float GetRepeatCooldown(const int32 mID) const;
+
+	/** @brief Number of branches of the mission associated with param 'mID', branch indices are in priority order */
+	int32 GetNumBranches(const int32 mID) const;
+
+	/** @brief mID the branch at param 'BranchIdx' targets, INDEX_NONE if unresolved. Param 'BranchIdx' must be within 'GetNumBranches' */
+	int32 GetBranchTargetMID(const int32 mID, const int32 BranchIdx) const;
+
+	/** @brief How the branch at param 'BranchIdx' is to be treated. Param 'BranchIdx' must be within 'GetNumBranches' */
+	FPDMissionBranchBehaviour GetBranchBehaviour(const int32 mID, const int32 BranchIdx) const;
+
+	/** @brief Assets to preload for the mission associated with param 'mID' */
+	TConstArrayView<TSoftObjectPtr<UObject>> GetPreloadAssets(const int32 mID) const;
+
 	/** @brief Get the mission metadata associated with param 'mID' */
 	const FPDMissionMetadata& GetMetadataBase(const int32 mID) const;  
 
+	/** @brief Get the interned condition tags of the mission associated with param 'mID' */
+	FPDMissionTagSetHandle GetConditionHandle(const int32 mID) const;
+
 	/** @brief Checks if param 'mID' is associated with valid mission or not. @return true if valid | false if not*/
 	bool IsValidMission(const int32 mID) const;   
 	
-	/** @brief Get the mission default data associated with param 'BaseTag' */
+	/** @brief Get the table row of the mission associated with param 'BaseTag'. Table rows only, see 'GetDefaultBase' */
 	FPDMissionRow* GetDefaultBaseViaTag(const FGameplayTag& BaseTag) const;   
 
-	/** @brief Get the mission rules associated with param 'BaseTag' */
+	/** @brief Get the mission rules associated with param 'BaseTag'. Table rows only, see 'GetDefaultBase' */
 	FPDMissionRules* GetMissionRulesViaTag(const FGameplayTag& BaseTag) const;  
 
 	/** @brief Get the mission metadata associated with param 'BaseTag' */
@@ -55,36 +285,156 @@ public:
 	/** @brief Checks if param 'BaseTag' is associated with valid mission or not. @return true if valid | false if not*/
 	bool IsValidMissionViaTag(const FGameplayTag& BaseTag) const;   
 	
-	/** @brief Get the level percentage */ 
+	/** @brief Resolves a handle for the mission associated with param 'BaseTag'. Unset handle if nothing was found */
+	FPDMissionHandle ResolveHandle(const FGameplayTag& BaseTag) const;
+
+	/** @brief Resolves a handle for the mission associated with param 'mID'. Unset handle if nothing was found */
+	FPDMissionHandle ResolveHandleViaMID(const int32 mID) const;
+
+	/** @brief Checks if the handle was resolved against the current database generation and still points to a mission */
+	bool IsValidHandle(const FPDMissionHandle& Handle) const;
+
+	/** @brief Get the table row of the mission associated with param 'Handle', O(1). nullptr if the handle is stale or the mission is served from the compiled database */
+	FPDMissionRow* GetDefaultBase(const FPDMissionHandle& Handle) const;
+
+	/** @brief Get the mission rules associated with param 'Handle', O(1). Table rows only, nullptr if the handle is stale */
+	FPDMissionRules* GetMissionRules(const FPDMissionHandle& Handle) const;
+
+	/** @brief Gets active mission data for mission with 'Handle' on the calling actor associated with the 'ActorID' */
+	FPDMissionNetDatum* GetMissionDatum(int32 ActorID, const FPDMissionHandle& Handle) const;
+
+	/** @brief Current database generation, bumped whenever the lookups are rebuilt or a mission table is changed */
+	FORCEINLINE int32 GetDatabaseGeneration() const { return DatabaseGeneration; }
+
+	/** @brief Number of dense mission slots, valid handle indices are in range [0, GetNumDenseMissions()) */
+	FORCEINLINE int32 GetNumDenseMissions() const { return DenseMissionRows.Num(); }
+
+	/** @brief Moves the actor from (mID, OldState) to (mID, NewState) in the state index. EINVALID_STATE on either side means not indexed */
+	void UpdateMissionStateIndex(int32 ActorID, int32 mID, EPDMissionState OldState, EPDMissionState NewState);
+
+	/** @brief Number of registered actors that hold the mission in 'State', O(1) */
+	int32 CountActorsInState(int32 mID, EPDMissionState State) const;
+
+	/** @brief Calls 'Func' with the ActorID of each registered actor that holds the mission in 'State' */
+	void ForEachActorInState(int32 mID, EPDMissionState State, TFunctionRef<void(int32 ActorID)> Func) const;
+
+	/** @brief Evaluates the conditions of the mission associated with 'mID' against 'Caller', memoized per tag container version of the caller */
+	bool EvaluateMissionConditions(const AActor* Caller, int32 mID);
+
+	/** @brief Evaluates the conditions of branch 'BranchIdx' of the mission associated with 'mID' against 'Caller', memoized per tag container version of the caller */
+	bool EvaluateBranchConditions(const AActor* Caller, int32 mID, int32 BranchIdx);
+
+	/** @brief Compiled pool associated with 'PoolTag', pools are recompiled when the database generation changes. nullptr if there is no such pool */
+	const FPDMissionPool* FindMissionPool(const FGameplayTag& PoolTag);
+
+	/**
+	 * @brief Draws up to 'Count' distinct missions out of the pool for the actor associated with 'ActorID', appending their mIDs to 'OutMIDs'
+	 * @note Only missions the actor holds as inactive, and meets the mission and pool entry conditions of, are eligible
+	 * @return Number of drawn missions
+	 */
+	int32 DrawMissionsFromPool(int32 ActorID, const FGameplayTag& PoolTag, int32 Count, const FRandomStream& Stream, TArray<int32>& OutMIDs);
+
+	/** @brief Rotation definition associated with 'RotationTag'. nullptr if there is no such rotation */
+	const FPDMissionRotationDefinition* FindMissionRotation(const FGameplayTag& RotationTag) const;
+
+	/**
+	 * @brief Appends the mIDs of the rotation that 'UtcTime' falls into to 'OutMIDs'. 'Salt' is i.e. a player or shard id
+	 * @note Deterministic, server and clients compute the same rotation on their own. Uses the precomputed result if there is one
+	 * @return Number of missions in the rotation
+	 */
+	int32 GetMissionRotation(const FGameplayTag& RotationTag, const FDateTime& UtcTime, int32 Salt, TArray<int32>& OutMIDs);
+
+	/** @brief Starts computing the rotation that 'UtcTime' falls into on a background thread, picked up by 'GetMissionRotation'. @return false if there is no such rotation */
+	bool PrecomputeMissionRotation(const FGameplayTag& RotationTag, const FDateTime& UtcTime, int32 Salt);
+
+	/** @brief Preloads the assets of the most likely branch targets of 'mID', branches 'Caller' currently meets the conditions of first. No-op on dedicated servers */
+	void PreloadBranchTargets(const AActor* Caller, int32 mID);
+
+	/** @brief Get the level percentage */
 	float CurrentMissionPercentage(const FGameplayTag& BaseTag, int32 ActorID) const;
 
 	/** @brief Sets a new mission datum on the calling tracker  */ 
 	void SetNewMissionDatum(UPDMissionTracker* MissionTracker, int32 SID, const FPDMissionNetDatum& Datum) const;
 
-	/** @brief Overwrite a mission datum on the calling tracker  */ 
+	/** @brief Overwrite a mission datum on the calling tracker. Written through UPDMissionTracker::SetMissionDatum, so a state more than one transition away from the current one is rejected, defaults included */ 
 	void OverwriteMissionDatum(UPDMissionTracker* MissionTracker, int32 SID, const FPDMissionNetDatum& NewDatum, bool ForceDefault = false) const;
 	
 // SETUP
 	/** @brief Called on creation to setup data */
-	void InitializeMissionSubsystem();
+	void InitializeMissionSubsystem(UPDMissionSubsystem* InOwningSubsystem);
 
 	/** @brief Return a const reference to the set mission tables */
 	const TArray<UDataTable*>& GetAllTables() const;
 
-	/** @brief Increments a replicated actorID */
-	static int32 RequestNewActorID(int32& LatestCreatedActorID); 
-	
-	/** @brief Registers users tracker events */
+	/** @brief Registers users tracker events. Assigns the tracker a new ActorID if it does not have a valid one */
 	void RegisterUser(UPDMissionTracker* Tracker);               
 	
-	/** @brief Deregisters users tracker events */
-	void DeRegisterUser(const UPDMissionTracker* Tracker);       
+	/** @brief Deregisters users tracker events, frees its tracker slot and invalidates its ActorID. The trackers state allocations are pooled for the next user */
+	void DeRegisterUser(UPDMissionTracker* Tracker);       
 	
 	/** @brief Reads and fills the lookup maps for the missions */
 	void ProcessTablesForFastLookup();                           
 	
+	/** @brief Fills the lookup maps from the compiled database, without touching the tables. Always false in editor builds. @return true if the database was used */
+	bool ProcessCompiledDatabase(int32& MissionID);
+	
+	/** @brief Reads a single table into the lookup maps, assigning mIDs starting after param 'MissionID'. @return number of processed rows */
+	int32 ProcessTableForFastLookup(UDataTable* MissionTable, int32& MissionID);
+
+	/** @brief Listens for changes to 'MissionTable' through the owning subsystem. Bound once per table, repeated calls are ignored */
+	void BindMissionTableChanged(UDataTable* MissionTable);
+
+	/** @brief Stops listening for changes to 'MissionTable' */
+	void UnbindMissionTableChanged(UDataTable* MissionTable);
+
+	/** @brief Stops listening for changes to any table */
+	void UnbindAllMissionTablesChanged();
+
+	/** @brief Bumps the revision of the table associated with 'TableID', row memory may have moved so the database generation is bumped as-well */
+	void OnMissionTableChanged(int32 TableID);
+
 	/** @brief Only call after ProcessTablesForFastLookup, as it will generate empty settings for each mapped mID */
 	void InitializeTracker(const int32 ActorID);                 
+
+	/** @brief Default datum of every mapped mission, in mID order. Rebuilt when the database generation changes */
+	const TArray<FPDMissionNetDatum>& GetDefaultDatumTemplate();
+
+	/** @brief Builds the default datum of the mission associated with 'mID', as a freshly initialized tracker would hold it */
+	FPDMissionNetDatum MakeDefaultDatum(const int32 mID) const;
+
+	/** @brief Checks if 'Datum' still holds the default state of its mission */
+	bool IsDefaultDatum(const FPDMissionNetDatum& Datum) const;
+
+	/** @brief Checksum over the default state of every mapped mission. Differs between processes whose default datums would differ. Rebuilt when the database generation changes */
+	uint32 GetDatabaseChecksum() const;
+
+	/** @brief Stores the database checksum a client reported for its connection. Server only */
+	void SetConnectionChecksum(const UNetConnection* Connection, uint32 Checksum);
+
+	/** @brief Did the connection report the same database checksum as ours, only then can it rebuild the default runs of a snapshot */
+	bool IsConnectionInSync(const UNetConnection* Connection) const;
+
+	/** @brief Reports the local database checksum to the server, through the first tracker this client owns. Client only */
+	void ReportDatabaseChecksum() const;
+
+	/** @brief First registered tracker this client owns, the only trackers a client can send server calls through. nullptr on the server */
+	UPDMissionTracker* GetLocallyOwnedTracker() const;
+
+	/** @brief Generates default settings for the missions in range [FirstMID, LastMID] on the tracker associated with 'ActorID' */
+	void InitializeTrackerRange(const int32 ActorID, const int32 FirstMID, const int32 LastMID);
+
+// STREAMING
+	/** @brief Finds the table group definition associated with 'GroupTag' */
+	const FPDMissionTableGroup* FindTableGroup(const FGameplayTag& GroupTag) const;
+
+	/** @brief Checks if the table group associated with 'GroupTag' has been merged into the lookups */
+	bool IsTableGroupLoaded(const FGameplayTag& GroupTag) const;
+
+	/** @brief Merges a loaded table group into the lookups and initializes its missions on all registered trackers */
+	bool MergeTableGroup(const FGameplayTag& GroupTag, const TArray<UDataTable*>& LoadedTables);
+
+	/** @brief Removes a table group from the lookups and its missions from all registered trackers. Invalidates all mission handles */
+	bool UnmergeTableGroup(const FGameplayTag& GroupTag);
 	
 	/** @brief Set a assigned mission event */
 	void BindMissionEvent(int32 ActorID, int32 mID, const FPDUpdateMission& MissionEventDelegate);
@@ -96,9 +446,24 @@ public:
 	void FillIntermediaryMissionList(bool bOverwrite);
 
 public:
-	/** @brief Map associating ActorIDs with their mission tracker  */
-	UPROPERTY()
-	TMap<int32, UPDMissionTracker*> MissionTrackerMap;
+	/**
+	 * @brief Dense array of mission trackers, indexed by the slot of their ActorID. Freed slots are nulled and reused
+	 * @note Not a UPROPERTY on purpose, the GC does not need to walk it. Trackers add and remove themselves from OnRegister/OnUnregister,
+	 *       so an entry never outlives its tracker, and stale ActorIDs are rejected by the allocators generation check
+	 */
+	TArray<UPDMissionTracker*> MissionTrackers;
+
+	/** @brief Allocator of the ActorIDs, used to reject stale IDs before indexing 'MissionTrackers' */
+	FPDMissionActorIDAllocator ActorIDAllocator;
+
+	/** @brief Which actors hold which mission in which state, updated by the trackers on every state change. Server only */
+	FPDMissionStateIndex MissionStateIndex;
+
+	/** @brief Memoized condition results */
+	FPDMissionConditionCache ConditionCache;
+
+	/** @brief Next condition id to assign, condition ids index the caches result bits */
+	int32 NextConditionID = 0;
 	
 	/** @brief Fast lookups of mission row-handles, keyed by their mID  */
 	TMap<int32, FDataTableRowHandle> MissionLookup {};
@@ -108,11 +473,72 @@ public:
 
 	/**< @brief Fast lookups. Associating rownames with rowhandles */
 	TMap<FName, FDataTableRowHandle> MissionLookupViaRowName {};
+
+	/**< @brief Fast lookups. Associating rownames with mIDs, also filled from the compiled database which has no row handles */
+	TMap<FName, int32> MissionRowNameToMIDLookup {};
 	
 	/**< @brief Edition/version/revision comparison checks */
 	TMap<int32 /*Session unique TableID*/, int32 /*editversion*/> TableRevisions{};
 
-	TMap<int32, int32> LastComparisonTableRevisions;	
+	TMap<int32, int32> LastComparisonTableRevisions;
+
+	/** @brief Dense row cache used by mission handles, indexed by 'mID - 1'. Only to be dereferenced via a handle that passes 'IsValidHandle'. Holds table rows only, missions served from the compiled database are read from its arrays and left nullptr */
+	TArray<FPDMissionRow*> DenseMissionRows {};
+
+	/** @brief Interned condition handler of each mission, indexed the same as 'DenseMissionRows' */
+	TArray<FPDMissionTagSetHandle> DenseConditionHandles {};
+
+	/** @brief Condition id of each mission, indexed the same as 'DenseMissionRows'. Its branches follow in order, branch 'BranchIdx' has id 'DenseConditionIDs[mID - 1] + 1 + BranchIdx' */
+	TArray<int32> DenseConditionIDs {};
+
+	/** @brief Bumped each time the lookups are rebuilt and each time a table revision changes, invalidates all previously resolved handles */
+	int32 DatabaseGeneration = 0;
+
+	/** @brief Highest mID that has been assigned or reserved */
+	int32 LatestMissionID = 0;
+
+	/** @brief Pooled allocations of deregistered trackers, handed to the next registering tracker */
+	TArray<FPDMissionTrackerStateBlock> TrackerStatePool {};
+
+	/** @brief Cached result of 'GetDefaultDatumTemplate' */
+	TArray<FPDMissionNetDatum> DefaultDatumTemplate {};
+
+	/** @brief Database generation 'DefaultDatumTemplate' was built against */
+	int32 DefaultDatumTemplateGeneration = INDEX_NONE;
+
+	/** @brief Cached result of 'GetDatabaseChecksum' */
+	mutable uint32 DatabaseChecksum = 0;
+
+	/** @brief Database generation 'DatabaseChecksum' was built against */
+	mutable int32 DatabaseChecksumGeneration = INDEX_NONE;
+
+	/** @brief Last database checksum each client connection reported, keyed by connection. Server only */
+	TMap<FObjectKey, uint32> ConnectionChecksums {};
+
+	/** @brief Compiled 'MissionPools', keyed by pool tag */
+	TMap<FGameplayTag, FPDMissionPool> CompiledMissionPools {};
+
+	/** @brief Database generation 'CompiledMissionPools' was built against */
+	int32 CompiledMissionPoolsGeneration = INDEX_NONE;
+
+	/** @brief Background preloads of upcoming missions */
+	FPDMissionPreloader Preloader;
+
+	/** @brief Rotations computed on a background thread, consumed by 'GetMissionRotation' */
+	TMap<FPDMissionRotationKey, TSharedFuture<TArray<int32>>> PrecomputedRotations {};
+
+	/** @brief Bindings of the tables OnDataTableChanged, removed again when a table is unmerged */
+	TMap<TObjectKey<UDataTable>, FDelegateHandle> MissionTableChangedHandles {};
+
+	/** @brief Subsystem owning this utility. Delegates that may fire after the utility has been copied are bound to it instead */
+	UPROPERTY()
+	UPDMissionSubsystem* OwningSubsystem = nullptr;
+
+	/** @brief Runtime state of the table groups, keyed by group tag */
+	TMap<FGameplayTag, FPDMissionTableGroupState> TableGroupStates {};
+
+	/** @brief Broadcasts whenever a table group has been merged or removed */
+	FPDOnMissionTableGroupChanged OnTableGroupChanged;
 
 #if WITH_EDITOR
 	TArray<TSharedPtr<FString>> MissionConcatList;
@@ -124,11 +550,68 @@ protected:
 	/** @brief Datatable of row-type FPDMissionRow */
 	UPROPERTY(EditAnywhere, Category = "Mission Subsystem", Meta = (RequiredAssetDataTags="RowStructure=/Script/PDMissionCore.PDMissionRow"))
 	TArray<UDataTable*> MissionTables {};
+
+	/** @brief Cook-time compiled mission database. When set, cooked builds fill the lookups from it instead of processing 'MissionTables' */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
+	TSoftObjectPtr<UPDMissionDatabase> CompiledDatabase {};
+
+	/** @brief The loaded compiled database, if any */
+	UPROPERTY()
+	UPDMissionDatabase* LoadedDatabase = nullptr;
+
+	/** @brief Cold metadata store of the loaded database, lazily loaded on first metadata request. Never loaded on dedicated servers */
+	UPROPERTY()
+	mutable UPDMissionMetadataStore* LoadedMetadataStore = nullptr;
+
+	/** @brief Max number of tracker state blocks kept around for reuse */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
+	int32 MaxPooledTrackerStates = 64;
+
+	/** @brief Soft referenced table groups (chapters/regions), streamed in asynchronously on request */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
+	TArray<FPDMissionTableGroup> MissionTableGroups {};
+
+	/** @brief Weighted mission pools, i.e. bounty boards, drawn from via 'DrawMissionsFromPool' */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
+	TArray<FPDMissionPoolDefinition> MissionPools {};
+
+	/** @brief Seeded daily/weekly rotations, each selecting from one of 'MissionPools' */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem")
+	TArray<FPDMissionRotationDefinition> MissionRotations {};
+
+	/** @brief Memory budget of the preloaded assets of upcoming missions */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem", Meta = (ClampMin = 0))
+	int32 PreloadBudgetMegabytes = 64;
+
+	/** @brief Max number of branch targets preloaded per active mission */
+	UPROPERTY(EditAnywhere, Category = "Mission Subsystem", Meta = (ClampMin = 0))
+	int32 MaxPreloadedBranchesPerMission = 2;
 	
 	/** @brief  Nested map of Mission events. TMap<ActorID, TMap<mID, Event Signature>> */
 	TMap<int32, FPDMissionTreeMap> BoundMissionEvents {};
 	
 private:
+	/** @brief Allocates a new ActorID, reusing the slot of a deregistered user if possible. Only handed out through 'RegisterUser', which also sizes the tracker array */
+	int32 RequestNewActorID(); 
+
+	/** @brief Writes a row into the dense row cache, growing it if needed */
+	void SetDenseMissionRow(const int32 mID, FPDMissionRow* MissionRow);
+
+	/** @brief Is param 'mID' served from the loaded compiled database */
+	bool IsCompiledMission(const int32 mID) const;
+
+	/** @brief Resolves the 'TargetMID' of each branch of the table rows, so branching never has to go through the row handles */
+	void ResolveBranchTargets();
+
+	/** @brief Evaluates the conditions of the mission associated with 'mID', or of its branch 'BranchIdx', through the condition cache. INDEX_NONE evaluates the mission itself */
+	bool EvaluateConditions(const AActor* Caller, int32 mID, int32 BranchIdx);
+
+	/** @brief Evaluates a tag condition and its compiled expression. Conditions of missions served from the compiled database are read from its flat arrays */
+	bool EvaluateConditionsUncached(const AActor* Caller, const IPDMissionInterface* AsInterface, int32 mID, int32 BranchIdx) const;
+
+	/** @brief Processes the groups loaded tables into its reserved mID range, reserving a new range if needed. @return first mID of the group */
+	int32 MergeTableGroupInternal(FPDMissionTableGroupState& GroupState);
+	
 	FPDMissionMetadata DummyMetadata = {FText::GetEmpty(), FText::GetEmpty()};
 	friend class UPDMissionSubsystem;
 };